@@ -8,32 +8,124 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
-#include <jack/jack.h>
+#include <math.h>
+#include "sample.h"
 #include "interface.h"
+#include "sweep.h"
+#include "ramp.h"
+
+#define COMPRESSOR_MAX_RATE 16  //Longest Control-Rate Interval (samples)
 
 typedef struct{
+    //Hot State - Everything compressor() reads per sample, together in the first cache line
     //User Parameters
     float ratio;            //Compression Ratio - Must be more than 20
     float knee_width;       //Transition Area in Compression Characteristic (dB)
                             //- Must be at least 0
     float threshold;        //Start of Compressor Characteristic (dB)
                             //- Usually taken as the minimum signal level
+    uint32_t control_rate;  //Gain Computer Interval (samples) - Must be in the range 1 to COMPRESSOR_MAX_RATE
+                            //- 1 runs every sample, longer intervals interpolate the linear gain in between
+    //Algorithmic Parameters
+    float gain, comps, att, rel, gs[2];
+    float att_hop, rel_hop, lin;
+    //Ramps - Checked every block and stepped only after a live change, filling the second line
+    ramp_parameters comps_ramp __attribute__((aligned(SAMPLE_LINE))), gain_ramp;
+    //Configuration - Read only when initialised, updated or set
+    //User Parameters
     float attack_t;         //Attack Time (s) - Must be greater than 0
     float release_t;        //Release Time (s) - Must be greater than 0.025
     float compression_db;   //Dynamic Range Compression (dB) - Must be at least 0
     float gain_db;          //Gain (dB)
     uint32_t chain;         //Position in effects line chain
-    //Algorithmic Parameters
-    float gain, comps, att, rel, gs[2];
 } compressor_parameters;
 
+typedef struct{
+    //User Parameters - One per variant, as for compressor_parameters
+    float ratio[SWEEP_LANES];
+    float knee_width[SWEEP_LANES];
+    float threshold[SWEEP_LANES];
+    float attack_t[SWEEP_LANES];
+    float release_t[SWEEP_LANES];
+    float compression_db[SWEEP_LANES];
+    float gain_db[SWEEP_LANES];
+    uint32_t lanes;         //Number of Variants - Must be in the range 1 to SWEEP_LANES
+    //Algorithmic Parameters
+    float gain[SWEEP_LANES], comps[SWEEP_LANES], att[SWEEP_LANES], rel[SWEEP_LANES];
+    float knee_lo[SWEEP_LANES], knee_hi[SWEEP_LANES], knee_slope[SWEEP_LANES], knee_den[SWEEP_LANES];
+    float gs[SWEEP_LANES];
+    uint32_t shared_curve;  //Set when every variant shares one gain computer and smoothing filter
+} compressor_sweep_parameters;
+
+typedef struct{
+    //Serialised State - Everything compressor() and compressor_set() change while running
+    float gs[2];
+    float lin;
+    float comps, gain;                      //Ramped Coefficients - As far as the ramps have reached
+    ramp_parameters comps_ramp, gain_ramp;  //So a snapshot taken mid-ramp resumes it
+    float compression_db, gain_db;          //Last values set
+} compressor_state;
+
+//Gain Computer - Gain change (dB) at input level db, every region evaluated then selected
+static inline float compressor_computer(compressor_parameters *comp, float db){
+    float x = db - comp->threshold + 0.5f * comp->knee_width;
+    float knee = db + (((1.0f/comp->ratio) - 1.0f) * (x * x)) / (2.0f * comp->knee_width);
+    float above = comp->threshold + (db - comp->threshold) / comp->ratio;
+    float sc = (db < (comp->threshold + 0.5f * comp->knee_width)) ? knee : above;
+    sc = (db < (comp->threshold - 0.5f * comp->knee_width)) ? db : sc;
+    return sc - db;
+}
+
+//Gain Smoothing - Advances gs by one sample towards gc (dB) and returns it
+static inline float compressor_smoothing(compressor_parameters *comp, float gc){
+    float coeff = (gc <= comp->gs[0]) ? comp->att : comp->rel;
+    comp->gs[1] = (coeff * comp->gs[0]) + (1.0f - coeff) * gc;
+    comp->gs[0] = comp->gs[1];
+    return comp->gs[1];
+}
+
 //Set Compressor Defaults
 void compressor_default(compressor_parameters *comp);
 
 //Initialise Compressor Parameters
 void compressor_init(compressor_parameters *comp, interface_parameters *inter);
 
+//Re-derive Parameters after a Buffer Size or Sample Rate change - No allocation
+void compressor_update(compressor_parameters *comp, interface_parameters *inter);
+
+//Compressor Stages - A block that straddles the knee, split so the parallel parts vectorise
+//- Curve writes each sample's gain target (dB) to g, smoothing turns g into gs in place (the only recurrence),
+//  and apply converts g to linear and mixes it into out. Run in order, they match the per-sample code exactly
+void compressor_stage_curve(compressor_parameters *comp, jack_default_audio_sample_t *in, float *g, uint32_t nframes);
+void compressor_stage_smooth(compressor_parameters *comp, float *g, uint32_t nframes);
+void compressor_stage_apply(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, float *g, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride);
+
+//Classified Block - One block as compressor() runs it: below-knee, above-knee and control-rate blocks take their
+//fast paths, others the stages above. comps and gain are per-sample ramps (stride 1) or settled values (stride 0)
+void compressor_block(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride);
+
 //Compressor Effect
 int compressor(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, interface_parameters *inter);
 
+//Change Compression and Gain while Running - Ramped over RAMP_T to avoid zipper noise
+void compressor_set(compressor_parameters *comp, float compression_db, float gain_db);
+
+//Size of Serialised State (bytes) - Fixed for the life of the instance
+size_t compressor_state_size(compressor_parameters *comp);
+
+//Snapshot State - buffer must be preallocated with compressor_state_size() bytes
+void compressor_snapshot(compressor_parameters *comp, void *buffer);
+
+//Restore State from a Snapshot
+int compressor_restore(compressor_parameters *comp, const void *buffer);
+
+//Set Sweep Defaults - Every variant starts as a copy of comp (including its gs state)
+void compressor_sweep_default(compressor_sweep_parameters *sweep, compressor_parameters *comp);
+
+//Initialise Sweep Parameters
+void compressor_sweep_init(compressor_sweep_parameters *sweep, interface_parameters *inter);
+
+//Compressor Parameter Sweep - Renders sweep->lanes variants of the same input into out[0..lanes-1]
+int compressor_sweep(jack_default_audio_sample_t *in, jack_default_audio_sample_t **out, compressor_sweep_parameters *sweep, interface_parameters *inter);
+
 #endif
@@ -0,0 +1,76 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __DELAY__
+#define __DELAY__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "sample.h"
+#include "interface.h"
+
+#define DELAY_MAX_T 4.0f        //Longest Tap Time (s) - Ring buffer is sized for this once
+#define DELAY_MAX_TAPS 4        //Most Taps
+#define DELAY_FADE 1024         //Crossfade Length (frames) when a tap time changes
+
+typedef struct{
+    //User Parameters
+    float time_t;       //Tap Spacing (s) - Must be in the range 0 to DELAY_MAX_T
+                        //- Ignored when tempo is set
+    float tempo;        //Tempo (bpm) - 0 for free time, otherwise taps are synced to the beat
+    float beats;        //Beats per Tap when synced - e.g. 1 = crotchet, 0.75 = dotted quaver
+    uint32_t taps;      //Number of Taps - Must be in the range 1 to DELAY_MAX_TAPS
+                        //- Tap n sounds at n times the tap spacing
+    float feedback;     //Feedback from last tap - Must be in the range 0 to 0.95
+    float damping;      //High Frequency Damping of repeats - Must be in the range 0 to 1 (bright to dark)
+    float mix;          //Wet Level - Must be in the range 0 to 1
+    float gain_db;      //Gain (dB)
+    uint32_t chain;     //Position in effects line chain
+    //Algorithmic Parameters
+    float *ring;        //Power-of-two ring buffer, indexed by masking
+    uint32_t capacity, mask, write_pos, fs;
+    uint32_t tap_from[DELAY_MAX_TAPS], tap_to[DELAY_MAX_TAPS], tap_fade[DELAY_MAX_TAPS];
+    uint32_t tap_next[DELAY_MAX_TAPS];  //Tap Time queued while a crossfade runs - Faded to once it completes
+    float tap_level[DELAY_MAX_TAPS], damp_coeff, lp, gain;
+} delay_parameters;
+
+typedef struct{
+    //Serialised State - Everything delay() and delay_set_time() change while running
+    float time_t, tempo;
+    uint32_t mask;          //Ring in use (frames - 1) - Must match the instance's, as only that much of the ring is copied
+    uint32_t fs, write_pos;
+    uint32_t tap_from[DELAY_MAX_TAPS], tap_to[DELAY_MAX_TAPS], tap_next[DELAY_MAX_TAPS], tap_fade[DELAY_MAX_TAPS];
+    float lp;
+    //Followed by capacity floats, the first mask + 1 copied from ring
+} delay_state;
+
+//Set Delay Defaults
+void delay_default(delay_parameters *dly);
+
+//Initialise Delay Parameters - Allocates the ring buffer for DELAY_MAX_T at INTERFACE_MAX_FS
+int delay_init(delay_parameters *dly, interface_parameters *inter);
+
+//Re-derive Parameters after a Buffer Size or Sample Rate change - No allocation
+//- A new sample rate clears the repeats, a new buffer size keeps them
+void delay_update(delay_parameters *dly, interface_parameters *inter);
+
+//Change Tap Time Live - Taps crossfade to the new time over DELAY_FADE frames, without reallocation
+//- A change during a crossfade is queued, and fades in from where that crossfade ends. Only the latest is kept
+void delay_set_time(delay_parameters *dly, float time_t, float tempo, interface_parameters *inter);
+
+//Size of Serialised State (bytes) - Fixed for the life of the instance, as the ring is sized for capacity
+size_t delay_state_size(delay_parameters *dly);
+
+//Snapshot State - buffer must be preallocated with delay_state_size() bytes. Copies the part of the ring in use
+void delay_snapshot(delay_parameters *dly, void *buffer);
+
+//Restore State from a Snapshot - Returns 1 if the stored ring is not the length this instance uses
+//- Snapshot and restore at the same rate and period
+int delay_restore(delay_parameters *dly, const void *buffer);
+
+//Delay Effect
+int delay(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, delay_parameters *dly, interface_parameters *inter);
+
+#endif
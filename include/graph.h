@@ -0,0 +1,102 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __GRAPH__
+#define __GRAPH__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "sample.h"
+#include "interface.h"
+#include "compressor.h"
+#include "overdrive.h"
+#include "delay.h"
+#include "octaver.h"
+
+#define GRAPH_MAX_NODES 32      //Most Nodes in a graph, including the input
+#define GRAPH_MAX_INPUTS 8      //Most Inputs to one node
+#define GRAPH_NAME 32           //Longest Node Name (including terminator)
+//Node Types
+#define GRAPH_INPUT 0           //The input port - Always node 0, named "in"
+#define GRAPH_COMPRESSOR 1
+#define GRAPH_OVERDRIVE 2
+#define GRAPH_DELAY 3
+#define GRAPH_OCTAVER 4
+#define GRAPH_LOWPASS 5         //2nd order Butterworth - For band splits
+#define GRAPH_HIGHPASS 6
+#define GRAPH_MIX 7             //Weighted sum of its inputs
+//Fixed Buffers - Scratch buffers are numbered from 2
+#define GRAPH_IN_BUFFER 0
+#define GRAPH_OUT_BUFFER 1
+
+typedef struct{
+    char name[GRAPH_NAME];
+    uint32_t type;
+    char input_names[GRAPH_MAX_INPUTS][GRAPH_NAME];
+    uint32_t ninputs;
+    float levels[GRAPH_MAX_INPUTS];     //Mix Level per input - Default is 1.0f
+    float cutoff;                       //Filter Cutoff (Hz) - Default is 250.0f
+    void *effect;                       //Effect Parameters - e.g. compressor_parameters for GRAPH_COMPRESSOR
+    uint32_t owned;                     //Set when the graph allocated the effect, and so frees it
+    uint32_t bypass;                    //Pass the first input straight through - 0 or 1, default 0. May change live
+    //Algorithmic Parameters
+    uint32_t inputs[GRAPH_MAX_INPUTS];
+    float coeffs[5], z[2];
+} graph_node;
+
+typedef struct{
+    uint32_t node;                      //Node run by this step
+    uint32_t inputs[GRAPH_MAX_INPUTS];  //Buffer read for each node input
+    uint32_t output;                    //Buffer written - May be one of the inputs (in place)
+} graph_step;
+
+typedef struct{
+    //User Parameters
+    graph_node nodes[GRAPH_MAX_NODES];
+    uint32_t nnodes;
+    char output_name[GRAPH_NAME];       //Node sent to the output port - Default is the last node added
+    uint32_t subblock;                  //Internal Sub-Block (frames) - 0 runs whole periods (default), otherwise a power
+                                        //of two from INTERFACE_MIN_NFRAMES. Periods it does not divide run whole
+    //Algorithmic Parameters
+    interface_parameters sub;           //Interface as the effects see it - nframes is the sub-block in use
+    graph_step schedule[GRAPH_MAX_NODES];
+    uint32_t nsteps, nbuffers;
+    float *scratch;                     //(nbuffers - 2) buffers of INTERFACE_MAX_NFRAMES - Reused by each sub-block
+} graph_parameters;
+
+//Set an Effect Parameter by its graph description name (e.g. "drive") - Before the effect is initialised
+//- Returns 0, 1 if the value is out of range, or 2 if type has no such parameter
+int graph_parameter(uint32_t type, void *effect, const char *key, float value);
+
+//Set Graph Defaults - Just the input node
+void graph_default(graph_parameters *graph);
+
+//Add a Node - inputs is a comma separated list of node names, which may be added later
+//- effect must already be initialised, and stays owned by the caller
+int graph_add(graph_parameters *graph, const char *name, uint32_t type, const char *inputs, void *effect);
+
+//Load a Graph Description - Creates and initialises the effects it names (see res/graphs)
+int graph_load(graph_parameters *graph, const char *path, interface_parameters *inter);
+
+//Compile - Topological schedule with scratch buffers assigned ahead of time, reused once their value is dead
+int graph_compile(graph_parameters *graph, interface_parameters *inter);
+
+//Re-derive every Node after a Buffer Size or Sample Rate change - No allocation
+//- Nodes are derived for the sub-block in use, not the period
+void graph_update(graph_parameters *graph, interface_parameters *inter);
+
+//Print the Compiled Schedule
+void graph_print(graph_parameters *graph);
+
+//Run the Compiled Schedule on one block - Real-time safe, node faults are logged (see logger.h) and silenced
+//- With a sub-block, the schedule runs once per sub-block on offsets into in and out, with no copies
+//- A block shorter than the sub-block in use runs as one short sub-block
+//- A bypassed node copies its first input and is not run, so its state holds until it is switched back in
+int graph_process(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, graph_parameters *graph, interface_parameters *inter);
+
+//Free Scratch Buffers and any Effects the graph created
+void graph_free(graph_parameters *graph);
+
+#endif
@@ -9,12 +9,18 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#define INTERFACE_MAX_NFRAMES 4096  //Largest Period (frames) effects are preallocated for
+#define INTERFACE_MIN_NFRAMES 16    //Smallest Period (frames) effects are preallocated for
+#define INTERFACE_MAX_FS 192000     //Highest Sample Rate (Hz) effects are preallocated for
+
 typedef struct{
     //User Parameters
     char *soundcard;    //Device name
     uint32_t nperiods;  //Periods per Buffer - Must be at least 1
-    uint32_t nframes;   //Frames per Period - Must be of the form 2^n
+    uint32_t nframes;   //Frames per Period - Must be of the form 2^n, at most INTERFACE_MAX_NFRAMES
     uint32_t fs;        //Sample Rate (Hz) - Usually 44100 or 48000, depending on soundcard
+                        //- At most INTERFACE_MAX_FS
+    uint32_t dummy;     //Run JACK on its dummy backend (no soundcard) - 0 or 1
     //Algorithmic Parameters
     uint32_t sclen, plen, flen, fslen;
 } interface_parameters;
@@ -0,0 +1,53 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __LOGGER__
+#define __LOGGER__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define LOGGER_RING 256         //Queued Records - Power of two, events beyond a full ring are counted but not queued
+#define LOGGER_WHERE 32         //Longest Source Name (including terminator) - As GRAPH_NAME
+//Events
+#define LOGGER_OVERDRIVE 0      //Overdrive static characteristic reached no region - The block is silenced
+#define LOGGER_NODE 1           //Effect graph node failed - Its output is silenced, value is its step
+#define LOGGER_PROCESS 2        //Effect graph failed in process() - The block is silenced
+#define LOGGER_XRUN 3           //JACK reported an xrun
+#define LOGGER_PERIOD 4         //JACK period changed - value is the new period (frames)
+#define LOGGER_RATE 5           //JACK sample rate changed - value is the new rate (Hz)
+#define LOGGER_PRESET 6         //MIDI program change recalled a preset - value is the program
+#define LOGGER_EVENTS 7
+
+typedef struct{
+    _Atomic uint32_t sequence;  //Slot Turn - Written last by the producer, so the record is complete when it matches
+    uint32_t event, value;
+    uint64_t time;              //CLOCK_MONOTONIC (ns)
+    char where[LOGGER_WHERE];
+} logger_record;
+
+//Record an Event - Real-time safe: lock-free, no allocation and no system calls that block
+//- Safe from any number of threads at once. Counted even when the ring is full
+void logger_event(uint32_t event, const char *where, uint32_t value);
+
+//Events Recorded since start up, queued or not
+uint32_t logger_count(uint32_t event);
+
+//Events Lost to a full ring
+uint32_t logger_dropped(void);
+
+//Format and Write everything queued to stream - Returns the number of records written
+//- One consumer at a time: the logger thread once started, otherwise the caller
+uint32_t logger_flush(FILE *stream);
+
+//Start and Stop the Background Writer Thread - Stopping writes anything still queued
+int logger_start(void);
+void logger_stop(void);
+
+//Print Event Counts to stream, if any event was recorded
+void logger_summary(FILE *stream);
+
+#endif
@@ -0,0 +1,93 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __MIDI__
+#define __MIDI__
+
+//MIDI Control - Control changes and program changes mapped onto the parameters the effects change live
+//- Changes are made at the frame they were sent for: the graph runs up to each event, then the event is applied
+//- Mapped parameters ramp (or crossfade) from that frame as any live change does, so nothing clicks
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "sample.h"
+#include "interface.h"
+#include "graph.h"
+
+#define MIDI_MAX_MAPS 32        //Most Control Change Mappings
+#define MIDI_MAX_PRESETS 32     //Most Program Change Presets
+#define MIDI_MAX_SETTINGS 8     //Most Parameters one preset sets
+#define MIDI_MAX_EVENTS 128     //Most Events split on per period - Any further are applied at its end
+#define MIDI_KEY 64             //Longest Parameter Key "<node>.<parameter>" (including terminator)
+//Live Parameters - Those the effects ramp while running
+#define MIDI_COMPRESSION_DB 0   //Compressor compression_db
+#define MIDI_COMPRESSOR_GAIN 1  //Compressor gain_db
+#define MIDI_DRIVE 2            //Overdrive drive
+#define MIDI_DRIVE_GAIN 3       //Overdrive gain_db
+#define MIDI_DELAY_TIME 4       //Delay time_t
+#define MIDI_TEMPO 5            //Delay tempo
+
+typedef struct{
+    uint32_t parameter;         //MIDI_COMPRESSION_DB to MIDI_TEMPO
+    void *effect;               //Effect Parameters of the node it belongs to
+    char key[MIDI_KEY];         //As given, for messages
+} midi_target;
+
+typedef struct{
+    uint32_t cc;                //Controller Number - 0 to 127
+    midi_target target;
+    float min, max;             //Value at controller values 0 and 127
+} midi_map;
+
+typedef struct{
+    uint32_t program;           //Program Number - 0 to 127
+    uint32_t nsettings;
+    midi_target targets[MIDI_MAX_SETTINGS];
+    float values[MIDI_MAX_SETTINGS];
+} midi_preset;
+
+typedef struct{
+    uint32_t time;              //Frame within the period
+    const uint8_t *data;        //Raw Message - Status byte first
+    size_t size;
+} midi_event;
+
+typedef struct{
+    //User Parameters
+    uint32_t channel;           //MIDI Channel - 1 to 16, or 0 for any
+                                //Default is 0
+    //Algorithmic Parameters
+    midi_map maps[MIDI_MAX_MAPS];
+    uint32_t nmaps;
+    midi_preset presets[MIDI_MAX_PRESETS];
+    uint32_t npresets;
+} midi_parameters;
+
+//Set MIDI Defaults - Nothing mapped
+void midi_default(midi_parameters *midi);
+
+//Map a Controller onto a live parameter of graph, "<node>.<parameter>", from min at 0 to max at 127
+//- Several parameters may share a controller. Returns 1 for an unknown node or parameter, a parameter that
+//  is fixed once running, or a range outside the parameter's
+int midi_map_cc(midi_parameters *midi, graph_parameters *graph, uint32_t cc, const char *key, float min, float max);
+
+//Add a Preset recalled by a Program Change - settings is a comma separated list of "<node>.<parameter>=<value>"
+int midi_map_program(midi_parameters *midi, graph_parameters *graph, uint32_t program, const char *settings);
+
+//Check one Message - Real-time safe. Returns 1 for a control change with a mapping, or a program change with
+//a preset, on the channel listened to. Anything else (clock, notes, unmapped controllers) changes nothing
+int midi_relevant(midi_parameters *midi, const uint8_t *data, size_t size);
+
+//Apply one Message - Real-time safe. Returns 1 if it changed a parameter
+//- inter is as the effects see it (graph->sub for a graph's nodes)
+int midi_apply(midi_parameters *midi, const uint8_t *data, size_t size, interface_parameters *inter);
+
+//Run a Period with its Events - The graph runs up to each event's frame, then the event is applied
+//- events are in frame order, as JACK delivers them. Only those midi_relevant() accepts split the period, so
+//  with none, this is graph_process() on the whole period
+//- Each split runs as a short block, so the overdrive's peak window (counted in blocks) is briefly shorter
+int midi_process(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, graph_parameters *graph, interface_parameters *inter, midi_parameters *midi, midi_event *events, uint32_t nevents);
+
+#endif
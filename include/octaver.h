@@ -0,0 +1,58 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __OCTAVER__
+#define __OCTAVER__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "sample.h"
+#include "interface.h"
+
+typedef struct{
+    //User Parameters
+    float sub_level;    //Octave-Down Level - Must be in the range 0 to 1
+    float dry_level;    //Dry Level - Must be in the range 0 to 1
+    float tracking;     //Tone - Low-pass cutoff as a multiple of the octave-down frequency
+                        //- Must be in the range 1 to 8 (dark to bright)
+    uint32_t quality;   //Divider Quality - 0 runs at fs, 1 runs 2x oversampled through polyphase
+                        //half-band filters (less jitter and aliasing, 3 frames more latency)
+    float gain_db;      //Gain (dB)
+    uint32_t chain;     //Position in effects line chain
+    //Algorithmic Parameters
+    float gain, pre_coeff, pre_lp[2], env, env_att, env_rel;
+    float sign, flip, count, period, post_lp[2];
+    float up_hist[4], down_hist[7];
+} octaver_parameters;
+
+typedef struct{
+    //Serialised State - Everything octaver() changes while processing
+    float pre_lp[2], env;
+    float sign, flip, count, period, post_lp[2];
+    float up_hist[4], down_hist[7];
+} octaver_state;
+
+//Set Octaver Defaults
+void octaver_default(octaver_parameters *oct);
+
+//Initialise Octaver Parameters
+void octaver_init(octaver_parameters *oct, interface_parameters *inter);
+
+//Re-derive Parameters after a Buffer Size or Sample Rate change - State is kept
+void octaver_update(octaver_parameters *oct, interface_parameters *inter);
+
+//Size of Serialised State (bytes) - Fixed for the life of the instance
+size_t octaver_state_size(octaver_parameters *oct);
+
+//Snapshot State - buffer must be preallocated with octaver_state_size() bytes
+void octaver_snapshot(octaver_parameters *oct, void *buffer);
+
+//Restore State from a Snapshot
+int octaver_restore(octaver_parameters *oct, const void *buffer);
+
+//Octaver Effect
+int octaver(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, octaver_parameters *oct, interface_parameters *inter);
+
+#endif
@@ -8,27 +8,112 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
-#include <jack/jack.h>
+#include <math.h>
+#include <float.h>
+#include "sample.h"
 #include "interface.h"
+#include "sweep.h"
+#include "ramp.h"
+
+#define OVERDRIVE_THRESHOLD 0.3333333f  //Static Characteristic Knee, as a fraction of the envelope
 
 typedef struct{
+    //Hot State - Everything overdrive() reads per block, together in the first cache line
+    //- window_store is allocated with sample_alloc(), so the window starts on a line of its own
+    //Algorithmic Parameters
+    uint32_t buffer_count, peak_count, peak_window, window_max;
+    float *window_store, gain, peak, high, drive_coeff, inv_drive_coeff, norm_factor;
+    //Ramps - Checked every block and stepped only after a live change, filling the next two lines
+    ramp_parameters drive_ramp __attribute__((aligned(SAMPLE_LINE))), norm_ramp, gain_ramp;
+    //Configuration - Read only when initialised, updated or set
     //User Parameters
     float drive;        //Overdrive Level - Must be in the range 0 to 1 (low to high)
     float window_t;     //Window Size (s) - Must be at most 59
     float gain_db;      //Gain (dB)
     uint32_t chain;     //Position in effects line chain
-    //Algorithmic Parameters
-    uint32_t buffer_count, peak_count, peak_window;
-    float *window_store, gain, peak, high, drive_coeff, inv_drive_coeff, norm_factor;
 } overdrive_parameters;
 
+typedef struct{
+    //User Parameters - One per variant, as for overdrive_parameters
+    //- window_t is shared, as the peak envelope is common to all variants
+    float drive[SWEEP_LANES];
+    float gain_db[SWEEP_LANES];
+    uint32_t lanes;     //Number of Variants - Must be in the range 1 to SWEEP_LANES
+    //Algorithmic Parameters
+    float gain[SWEEP_LANES], drive_coeff[SWEEP_LANES], norm_factor[SWEEP_LANES];
+} overdrive_sweep_parameters;
+
+typedef struct{
+    //Serialised State - Everything overdrive(), overdrive_set() and the window counters change while running
+    uint32_t peak_window;   //Window length (blocks) - Restored with the window, must be 1 to the instance's window_max
+    uint32_t buffer_count, peak_count;
+    float peak;
+    float drive_coeff, inv_drive_coeff, norm_factor, gain;      //Ramped Coefficients - As far as the ramps have reached
+    ramp_parameters drive_ramp, norm_ramp, gain_ramp;           //So a snapshot taken mid-ramp resumes it
+    float drive, gain_db;                                       //Last values set
+    //Followed by window_max floats, the first peak_window copied from window_store
+} overdrive_state;
+
+//Static Characteristic, given norm = in / env - Output before normalisation and gain, every region evaluated
+//then selected. Zero, NaN and Inf inputs give 0, as in overdrive()
+static inline float overdrive_shape(float in, float norm, float env){
+    float abs = fabsf(norm);
+    float curve = 3.0f - (2.0f - abs * 3.0f) * (2.0f - abs * 3.0f);
+    float mid = (norm > 0.0f) ? env * curve / 3.0f : env * (-curve / 3.0f);
+    float y = (norm > 0.0f) ? env : -env;
+    y = (abs <= (2.0f * OVERDRIVE_THRESHOLD)) ? mid : y;
+    y = (abs <= OVERDRIVE_THRESHOLD) ? 2.0f * in : y;
+    return ((abs > 0.0f) && (abs <= FLT_MAX)) ? y : 0.0f;
+}
+
+//Static Characteristic over a Block with a Constant Envelope, scaled by k (gain over normalisation)
+//- One reciprocal for the block and a multiply per sample, instead of a division per sample
+//- norm is then within 1ulp of in / env, and the regions meet continuously, so out stays within 4ulp of env
+//  of the per-sample division (bench peak checks this). env must be normal - its reciprocal overflows below FLT_MIN
+static inline void overdrive_curve_block(const float *in, float *out, float env, float k, uint32_t n){
+    const float inv_env = 1.0f / env;
+    for (uint32_t i = 0; i < n; i++){
+        out[i] = k * overdrive_shape(in[i], in[i] * inv_env, env);
+    }
+}
+
 //Set Default Parameters
 void overdrive_default(overdrive_parameters *drive);
 
 //Initialise Overdrive Parameters
 int overdrive_init(overdrive_parameters *drive, interface_parameters *inter);
 
-//Overdrive Effect
+//Re-derive Parameters after a Buffer Size or Sample Rate change - No allocation
+//- The window restarts holding the current peak, so the envelope carries on smoothly
+void overdrive_update(overdrive_parameters *drive, interface_parameters *inter);
+
+//Overdrive Effect - Returns 1, with the block silenced and the fault logged, if the static characteristic fails
 int overdrive(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, overdrive_parameters *drive, interface_parameters *inter);
 
+//Peak Envelope for one Block, given its peak - Returns the stride env is read with
+//- 0 when the envelope is constant, held in env[0]. Window counters are advanced by the caller, as for overdrive()
+uint32_t overdrive_envelope(jack_default_audio_sample_t *in, float local_peak, float *env, overdrive_parameters *drive, interface_parameters *inter);
+
+//Change Drive and Gain while Running - Ramped over RAMP_T to avoid zipper noise
+void overdrive_set(overdrive_parameters *drive, float drive_level, float gain_db);
+
+//Size of Serialised State (bytes) - Fixed for the life of the instance, as the window is sized for window_max
+size_t overdrive_state_size(overdrive_parameters *drive);
+
+//Snapshot State - buffer must be preallocated with overdrive_state_size() bytes
+void overdrive_snapshot(overdrive_parameters *drive, void *buffer);
+
+//Restore State from a Snapshot - Returns 1 if the stored window is longer than this instance's window_max
+int overdrive_restore(overdrive_parameters *drive, const void *buffer);
+
+//Set Sweep Defaults - Every variant starts as a copy of drive
+void overdrive_sweep_default(overdrive_sweep_parameters *sweep, overdrive_parameters *drive);
+
+//Initialise Sweep Parameters
+void overdrive_sweep_init(overdrive_sweep_parameters *sweep, interface_parameters *inter);
+
+//Overdrive Parameter Sweep - Renders sweep->lanes variants of the same input into out[0..lanes-1]
+//- Peak envelope state is taken from, and advanced in, drive
+int overdrive_sweep(jack_default_audio_sample_t *in, jack_default_audio_sample_t **out, overdrive_parameters *drive, overdrive_sweep_parameters *sweep, interface_parameters *inter);
+
 #endif
@@ -0,0 +1,80 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __PEAK__
+#define __PEAK__
+
+//Peak Detection Kernels - Block peak and running peak of |x|, four samples per step in GCC vector types
+//- 4 lanes map onto one NEON or SSE register, where the scalar loops carry a dependency through every sample
+//- Max is exact whatever order it is taken in, so both match their scalar loops bit for bit
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define PEAK_LANES 4
+
+typedef float peak_v4 __attribute__((vector_size(PEAK_LANES * sizeof(float))));
+typedef int32_t peak_m4 __attribute__((vector_size(PEAK_LANES * sizeof(float))));
+
+//Lane-wise a > b ? a : b - NaN in a loses, as the scalar compare-select does
+static inline peak_v4 peak_max4(peak_v4 a, peak_v4 b){
+    peak_m4 mask = (a > b);
+    return (peak_v4)(((peak_m4)a & mask) | ((peak_m4)b & ~mask));
+}
+
+static inline peak_v4 peak_abs4(const float *x){
+    peak_v4 v;
+    memcpy(&v, x, sizeof(v));
+    return (peak_v4)((peak_m4)v & 0x7fffffff);
+}
+
+//Block Peak - Largest |x[i]|, NaN ignored and 0 for an empty or silent block
+//- Two accumulators, so consecutive steps do not wait on each other
+static inline float peak_max_abs(const float *x, uint32_t n){
+    peak_v4 acc0 = {0.0f, 0.0f, 0.0f, 0.0f};
+    peak_v4 acc1 = acc0;
+    uint32_t i, k;
+    for (i = 0; i + 2 * PEAK_LANES <= n; i += 2 * PEAK_LANES){
+        acc0 = peak_max4(peak_abs4(&x[i]), acc0);
+        acc1 = peak_max4(peak_abs4(&x[i + PEAK_LANES]), acc1);
+    }
+    acc0 = peak_max4(acc1, acc0);
+    float peak = 0.0f;
+    for (k = 0; k < PEAK_LANES; k++){
+        peak = (acc0[k] > peak) ? acc0[k] : peak;
+    }
+    //Tail - Blocks are whole steps except a renderer's last
+    for (; i < n; i++){
+        float abs = fabsf(x[i]);
+        peak = (abs > peak) ? abs : peak;
+    }
+    return peak;
+}
+
+//Running Peak - out[i] is the largest of prev and |x[0..i]|, NaN ignored
+//- Log-step scan within each step (lanes take the max of the lane 1 then 2 before), then the previous step's
+//  last lane carried across - 2 shifts and 4 maxes per 4 samples, with one dependency between steps
+static inline void peak_prefix_max(const float *x, uint32_t n, float prev, float *out){
+    const peak_v4 zero = {0.0f, 0.0f, 0.0f, 0.0f};
+    peak_v4 v, carry;
+    uint32_t i;
+    for (i = 0; i + PEAK_LANES <= n; i += PEAK_LANES){
+        //NaN to 0 first - A NaN shifted into a later lane would otherwise win its compare there
+        v = peak_max4(peak_abs4(&x[i]), zero);
+        v = peak_max4(v, __builtin_shuffle(v, zero, (peak_m4){4, 0, 1, 2}));
+        v = peak_max4(v, __builtin_shuffle(v, zero, (peak_m4){4, 4, 0, 1}));
+        carry = (peak_v4){prev, prev, prev, prev};
+        v = peak_max4(v, carry);
+        memcpy(&out[i], &v, sizeof(v));
+        prev = v[PEAK_LANES - 1];
+    }
+    for (; i < n; i++){
+        float abs = fabsf(x[i]);
+        prev = (abs > prev) ? abs : prev;
+        out[i] = prev;
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __POOL__
+#define __POOL__
+
+//Worker Pool - Runs one period's tasks across real-time worker threads, returning once all are done
+//- The calling thread (JACK's) works too, so no thread is left waiting while there is work to take
+//- Each thread has its own deque, dealt the same tasks every period so a rig's state stays in one core's cache,
+//  and steals from the others once its own is empty (Chase-Lev, with no pushes while a period runs)
+//- Workers spin briefly between periods, then sleep on a semaphore posted by the next run
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#define POOL_MAX_WORKERS 15     //Most Worker Threads, besides the caller
+#define POOL_MAX_TASKS 64       //Most Tasks per run
+#define POOL_SPIN 20000         //Polls before an idle worker sleeps - Tens of microseconds
+#define POOL_LINE 64            //Cache Line (bytes) - Deques and counters written by different threads are kept apart
+
+typedef void (*pool_function)(void *arg);
+
+typedef struct{
+    pool_function function;
+    void *arg;
+} pool_task;
+
+typedef struct{
+    _Atomic int32_t top __attribute__((aligned(POOL_LINE)));     //Next task to steal - Taken by thieves
+    _Atomic int32_t bottom;                                     //One past the next task to pop - Taken by the owner
+    pool_task tasks[POOL_MAX_TASKS];
+} pool_deque;
+
+typedef struct pool_parameters pool_parameters;
+
+typedef struct{
+    pool_parameters *pool;
+    uint32_t index;                     //Deque owned - 0 is the caller's
+    pthread_t thread;
+    sem_t wake;
+    atomic_int sleeping;
+} pool_worker;
+
+struct pool_parameters{
+    //User Parameters
+    uint32_t nworkers;                  //Worker Threads besides the caller - Must be at most 15
+                                        //Default is one per core besides the caller's
+    int priority;                       //SCHED_FIFO Priority of the workers - 0 for default scheduling
+                                        //Default is 0 - Hosts pass JACK's (jack_client_real_time_priority)
+    //Algorithmic Parameters
+    pool_deque deques[POOL_MAX_WORKERS + 1];
+    pool_worker workers[POOL_MAX_WORKERS];
+    _Atomic uint32_t generation __attribute__((aligned(POOL_LINE)));    //Runs started
+    _Atomic uint32_t closed;                                           //Last run finished
+    _Atomic uint32_t busy __attribute__((aligned(POOL_LINE)));          //Workers inside the current run
+    _Atomic uint32_t remaining __attribute__((aligned(POOL_LINE)));     //Tasks of the current run not yet done
+    atomic_int running;
+    uint32_t started;                   //Worker Threads created
+};
+
+//Set Pool Defaults
+void pool_default(pool_parameters *pool);
+
+//Start the Worker Threads - Falls back to default scheduling, with a warning, where SCHED_FIFO is not permitted
+int pool_start(pool_parameters *pool);
+
+//Run Tasks across the Pool, returning once every one has finished - Real-time safe, no allocation or locks
+//- At most POOL_MAX_TASKS, and from one thread at a time. Returns 1 if there are too many
+int pool_run(pool_parameters *pool, pool_task *tasks, uint32_t ntasks);
+
+//Stop and Join the Worker Threads
+void pool_stop(pool_parameters *pool);
+
+#endif
@@ -0,0 +1,41 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __RAMP__
+#define __RAMP__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "interface.h"
+
+#define RAMP_T 0.02f            //Ramp Time (s) - Long enough that a full-scale step does not click
+#define RAMP_LINEAR 0           //Equal steps - For values that are already in dB or mix amounts
+#define RAMP_EXPONENTIAL 1      //Equal ratios - For linear gains, so the ramp is linear in dB
+#define RAMP_STRIDE 8           //Exponential ramps are generated RAMP_STRIDE values at a time
+
+typedef struct{
+    //User Parameters
+    uint32_t shape;     //RAMP_LINEAR or RAMP_EXPONENTIAL
+    //Algorithmic Parameters
+    uint32_t length, remaining, stepping;
+    float current, target, step, stride_step;
+} ramp_parameters;
+
+//Initialise a Settled Ramp at value
+void ramp_init(ramp_parameters *ramp, float value, uint32_t shape, interface_parameters *inter);
+
+//Re-derive Ramp Length after a Sample Rate change - A ramp in progress restarts from where it had reached
+void ramp_update(ramp_parameters *ramp, interface_parameters *inter);
+
+//Start a Ramp from current to target over RAMP_T
+void ramp_set(ramp_parameters *ramp, float current, float target);
+
+//Returns 1 when the ramp has reached its target - Callers skip ramp_block() entirely
+int ramp_settled(ramp_parameters *ramp);
+
+//Fill values[0..nframes-1] with the next nframes ramp values and advance
+void ramp_block(ramp_parameters *ramp, float *values, uint32_t nframes);
+
+#endif
@@ -0,0 +1,84 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __RRIPPLE__
+#define __RRIPPLE__
+
+//librripple - The effects and chains without JACK, for offline pipelines and other hosts
+//- Handles are opaque, so the effect structures can change without breaking callers
+//- Buffers are owned by the caller, and any length is processed as whole blocks with a shorter last block
+//- A handle is used from one thread at a time, different handles are independent
+//- Denormals are flushed to zero while processing, as on the pedal, and the caller's floating-point mode put back
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RRIPPLE_VERSION 1       //API Version - Raised only when an existing call changes
+#define RRIPPLE_API __attribute__((visibility("default")))
+//Node Types - As in graph descriptions (see res/graphs)
+#define RRIPPLE_COMPRESSOR 1
+#define RRIPPLE_OVERDRIVE 2
+#define RRIPPLE_DELAY 3
+#define RRIPPLE_OCTAVER 4
+#define RRIPPLE_LOWPASS 5       //Chain nodes only - cutoff (Hz), default 250
+#define RRIPPLE_HIGHPASS 6
+#define RRIPPLE_MIX 7           //Chain nodes only - Sums its inputs, levels set in graph descriptions
+
+typedef struct rripple rripple;
+
+//Automation Point - A parameter change at a frame, counted from the start of the rripple_process_automation call
+typedef struct{
+    uint64_t frame;
+    const char *key;            //As for rripple_set - e.g. "dirt.drive", "echo.bypass"
+    float value;
+} rripple_point;
+
+//Library API Version - Compare against RRIPPLE_VERSION
+RRIPPLE_API uint32_t rripple_version(void);
+
+//Create an Effect with its defaults - block is the period it runs in (frames), a power of two from 16 to 4096
+//- Returns NULL on failure
+RRIPPLE_API rripple *rripple_create(uint32_t type, uint32_t fs, uint32_t block);
+
+//Create an empty Chain - Nodes are added with rripple_chain_add
+RRIPPLE_API rripple *rripple_chain_create(uint32_t fs, uint32_t block);
+
+//Create a Chain from a Graph Description file - The chain creates and owns its effects
+RRIPPLE_API rripple *rripple_chain_load(const char *path, uint32_t fs, uint32_t block);
+
+//Add a Node to a Chain - inputs is a comma separated list of node names ("in" is the chain input)
+//- effect is an effect handle of the same type, or NULL for RRIPPLE_LOWPASS, RRIPPLE_HIGHPASS and RRIPPLE_MIX
+//- The chain runs the effect from then on, and must be destroyed before it
+RRIPPLE_API int rripple_chain_add(rripple *chain, const char *name, uint32_t type, const char *inputs, rripple *effect);
+
+//Set a Parameter by its graph description name (e.g. "drive", "compression_db")
+//- On a chain, "<node>.<parameter>", or "subblock" for the chain itself
+//- "<node>.bypass" (0 or 1) passes a chain node's first input straight through, and may change at any time
+//- Parameters are fixed once an effect starts (its first block, or a chain file's load), except those the
+//  pedal ramps live - compression_db and gain_db of the compressor, drive and gain_db of the overdrive,
+//  and time_t and tempo of the delay
+//- Returns 0, or 1 for an unknown parameter, a value out of range, or a fixed parameter
+RRIPPLE_API int rripple_set(rripple *fx, const char *key, float value);
+
+//Process nframes from in to out - in and out may be the same buffer
+//- Returns 0, or 1 if a block faulted (that block is silenced)
+RRIPPLE_API int rripple_process(rripple *fx, const float *in, float *out, uint64_t nframes);
+
+//Process nframes with Automation - Each point is applied at its frame, sample-accurately
+//- points are in frame order. Blocks holding points are split at them, the rest run as rripple_process()
+//- A point whose key or value is rejected is skipped (see rripple_set)
+//- Returns 0, or the sum of 1 if a block faulted and 2 if a point was skipped
+RRIPPLE_API int rripple_process_automation(rripple *fx, const float *in, float *out, uint64_t nframes, const rripple_point *points, uint32_t npoints);
+
+//Destroy an Effect or Chain - A chain is destroyed before the effects added to it
+RRIPPLE_API void rripple_destroy(rripple *fx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __SAMPLE__
+#define __SAMPLE__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define SAMPLE_LINE 64          //Cache Line (bytes) - Effect state read every block is kept on lines of its own
+
+//Audio Sample Type - JACK's, or the same float when built without JACK (RRIPPLE_NO_JACK, see include/rripple.h)
+#ifdef RRIPPLE_NO_JACK
+typedef float jack_default_audio_sample_t;
+#else
+#include <jack/jack.h>
+#endif
+
+//Flush Denormals to Zero on the Calling Thread - Subnormal samples, from an interface or a filter decaying towards
+//silence, otherwise take a microcoded slow path that can cost a whole period. Set by every real-time thread
+//- Returns the previous floating-point control register, for sample_restore_denormals()
+static inline uint64_t sample_flush_denormals(){
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE__))
+    uint32_t csr = __builtin_ia32_stmxcsr();
+    __builtin_ia32_ldmxcsr(csr | 0x8040);      //Flush to Zero and Denormals are Zero
+    return csr;
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr | (1 << 24)));    //FZ
+    return fpcr;
+#elif defined(__arm__) && defined(__ARM_FP)
+    uint32_t fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    __asm__ volatile("vmsr fpscr, %0" : : "r"(fpscr | (1 << 24)));  //FZ - NEON always flushes
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+//Restore the Floating-Point Control Register - For callers who share the thread, e.g. the library's
+static inline void sample_restore_denormals(uint64_t mode){
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE__))
+    __builtin_ia32_ldmxcsr((uint32_t)mode);
+#elif defined(__aarch64__)
+    __asm__ volatile("msr fpcr, %0" : : "r"(mode));
+#elif defined(__arm__) && defined(__ARM_FP)
+    __asm__ volatile("vmsr fpscr, %0" : : "r"((uint32_t)mode));
+#else
+    (void)mode;
+#endif
+}
+
+//Cache-Line Aligned Allocation - For effect parameters, whose hot state is aligned to SAMPLE_LINE, and the
+//buffers they own. Freed with free(), returns NULL on failure
+static inline void *sample_alloc(size_t size){
+    void *memory = NULL;
+    return (posix_memalign(&memory, SAMPLE_LINE, (size > 0) ? size : 1) == 0) ? memory : NULL;
+}
+
+#endif
@@ -0,0 +1,12 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __SWEEP__
+#define __SWEEP__
+
+//Parameter Sweep Lanes - Variants are laid out across SIMD lanes (structure-of-arrays)
+//- 8 lanes fill two NEON or one AVX float register
+#define SWEEP_LANES 8
+
+#endif
@@ -0,0 +1,103 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __TRACE__
+#define __TRACE__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//Event Tracer - Compiled in with make TRACE=1, otherwise every TRACE_ macro is empty
+//- Begin/end, span and instant events go into a ring per thread, written out as Chrome trace JSON
+//- Spans share their boundary timestamps, so a run of steps costs one counter read per step
+#define TRACE_RING 65536        //Events kept per thread - Power of two, the oldest are overwritten
+#define TRACE_THREADS 8         //Most Threads traced
+
+typedef struct{
+    uint64_t time;              //Ticks - TSC, the ARM virtual counter or CLOCK_MONOTONIC (ns)
+    uint64_t end;               //Ticks at the end of a span ('X') - Unused otherwise
+    const char *name;           //Must outlive the trace - String literals or node names
+    uint32_t phase;             //'B', 'E', 'X' or 'i'
+} trace_event;
+
+typedef struct{
+    trace_event events[TRACE_RING];
+    _Atomic uint64_t count;     //Events ever recorded - Only the owning thread writes
+    const char *name;
+} trace_ring;
+
+#ifdef TRACE
+#define TRACE_BEGIN(name) trace_record((name), 'B')
+#define TRACE_END(name) trace_record((name), 'E')
+#define TRACE_INSTANT(name) trace_record((name), 'i')
+#define TRACE_THREAD(name) trace_thread(name)
+#define TRACE_MARK(mark) uint64_t mark = trace_ticks()
+#define TRACE_SPAN(name, mark) trace_span((name), &(mark))
+#else
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#define TRACE_INSTANT(name)
+#define TRACE_THREAD(name)
+#define TRACE_MARK(mark)
+#define TRACE_SPAN(name, mark)
+#endif
+
+extern atomic_int trace_enabled;
+
+//Cheapest Counter available - Calibrated against CLOCK_MONOTONIC when dumped
+static inline uint64_t trace_ticks(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t t;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+#endif
+}
+
+//Record one Event on the calling thread's ring - Lock-free and allocation free
+//- A thread claims a preallocated ring on its first event
+void trace_record_event(const char *name, uint32_t phase);
+
+//Record a Span from mark to now, moving mark on to now - For back to back steps
+void trace_record_span(const char *name, uint64_t start, uint64_t end);
+
+static inline void trace_record(const char *name, uint32_t phase){
+    if (atomic_load_explicit(&trace_enabled, memory_order_relaxed)){
+        trace_record_event(name, phase);
+    }
+}
+
+static inline void trace_span(const char *name, uint64_t *mark){
+    if (atomic_load_explicit(&trace_enabled, memory_order_relaxed)){
+        uint64_t end = trace_ticks();
+        trace_record_span(name, *mark, end);
+        *mark = end;
+    }
+}
+
+//Name the Calling Thread in the trace
+void trace_thread(const char *name);
+
+//Start or Pause Recording - Starting also fixes the trace's time origin
+void trace_enable(int enable);
+
+//Events held across every thread's ring
+uint64_t trace_count(void);
+
+//Write every Ring as Chrome trace JSON (chrome://tracing or ui.perfetto.dev) - Call once recording has stopped
+//- Returns 1 if tracing is not compiled in or the file cannot be written
+int trace_dump(const char *path);
+
+#endif
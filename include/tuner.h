@@ -0,0 +1,64 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __TUNER__
+#define __TUNER__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "sample.h"
+#include "interface.h"
+
+#define TUNER_RING 16384        //Input Ring Length (frames) - Power of two, ~340ms at 48kHz
+#define TUNER_RATE 4000         //Analysis Rate (Hz) after decimation
+#define TUNER_FRAME 512         //Analysis Frame (decimated frames)
+#define TUNER_TAU 192           //Longest Period searched (decimated frames) - ~21Hz, below E1 (41.2Hz)
+#define TUNER_HOP 128           //Decimated frames between estimates (~32ms)
+
+typedef struct{
+    //User Parameters
+    uint32_t enabled;   //Run Tuner - 0 or 1
+    float reference;    //Reference Pitch for A4 (Hz) - Must be in the range 400 to 480
+    float threshold;    //YIN Absolute Threshold - Must be in the range 0 to 1, lower is stricter
+    //Algorithmic Parameters
+    float *ring;
+    _Atomic uint32_t write_pos, read_pos, dropped, rate;
+    _Atomic uint64_t result;
+    atomic_int running;
+    pthread_t thread;
+    uint32_t decimation, phase, fill, fs;
+    float biquad[2][5], z[2][2];
+    float frame[TUNER_FRAME], diff[TUNER_TAU];
+} tuner_parameters;
+
+//Set Tuner Defaults
+void tuner_default(tuner_parameters *tuner);
+
+//Initialise Tuner Parameters
+int tuner_init(tuner_parameters *tuner, interface_parameters *inter);
+
+//Sample Rate Change - Picked up by the analysis thread before it reads further
+void tuner_update(tuner_parameters *tuner, interface_parameters *inter);
+
+//Copy a Block into the Ring - The only call made from process()
+void tuner_push(jack_default_audio_sample_t *in, tuner_parameters *tuner, interface_parameters *inter);
+
+//Analyse Everything Queued - Returns 1 if a new estimate was published
+int tuner_analyse(tuner_parameters *tuner);
+
+//Start and Stop the Background Analysis Thread
+int tuner_start(tuner_parameters *tuner);
+void tuner_stop(tuner_parameters *tuner);
+
+//Latest Estimate - Returns 1 and fills frequency (Hz), cents from the nearest note and its name
+//(at least 5 chars), or 0 when no pitch is detected
+int tuner_read(tuner_parameters *tuner, float *freq, float *cents, char *name);
+
+//Free Tuner Memory
+void tuner_free(tuner_parameters *tuner);
+
+#endif
@@ -0,0 +1,28 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#ifndef __WAV__
+#define __WAV__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+typedef struct{
+    uint32_t fs;        //Sample Rate (Hz)
+    uint32_t channels;  //Channels in file - Only the first is kept
+    uint32_t length;    //Length (frames)
+    float *data;        //Samples of first channel, in the range -1 to 1
+} wav_file;
+
+//Read WAV File - 16/24/32-bit PCM or 32-bit float
+int wav_read(const char *path, wav_file *wav);
+
+//Write WAV File - data as mono 32-bit float at fs (channels is ignored)
+int wav_write(const char *path, wav_file *wav);
+
+//Free WAV File Samples
+void wav_free(wav_file *wav);
+
+#endif
@@ -4,7 +4,9 @@
 
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
 #include "compressor.h"
+#include "trace.h"
 
 static inline float db2lin(float db){
     return powf(10.0f, 0.05f * db);
@@ -23,6 +25,7 @@ void compressor_default(compressor_parameters *comp){
     comp->release_t = 0.3f;
     comp->compression_db = 6.0f;
     comp->gain_db = 0.0f;
+    comp->control_rate = 1;
     comp->gs[0] = 0.0f;
     comp->gs[1] = 0.0f;
     comp->chain = 0;
@@ -32,6 +35,14 @@ void compressor_init(compressor_parameters *comp, interface_parameters *inter){
     //Parameter Initialisation
     comp->comps = db2lin(comp->compression_db) - 1.0f;
     comp->gain = db2lin(comp->gain_db);
+    //Runtime Changes - Settled at the initial values
+    ramp_init(&comp->comps_ramp, comp->comps, RAMP_LINEAR, inter);
+    ramp_init(&comp->gain_ramp, comp->gain, RAMP_EXPONENTIAL, inter);
+    compressor_update(comp, inter);
+}
+
+void compressor_update(compressor_parameters *comp, interface_parameters *inter){
+    //Sample Rate Dependants
     if (comp->attack_t == 0.0f){
         comp->att = 0.0f;
     }
@@ -44,71 +55,334 @@ void compressor_init(compressor_parameters *comp, interface_parameters *inter){
     else{
         comp->rel = expf(-log10f(9.0f)/((float)inter->fs * comp->release_t));
     }
+    //Control Rate - Smoothing once per interval decays as far as control_rate samples would
+    comp->att_hop = powf(comp->att, (float)comp->control_rate);
+    comp->rel_hop = powf(comp->rel, (float)comp->control_rate);
+    comp->lin = db2lin(comp->gs[0]);
+    ramp_update(&comp->comps_ramp, inter);
+    ramp_update(&comp->gain_ramp, inter);
+}
+
+void compressor_stage_curve(compressor_parameters *comp, jack_default_audio_sample_t *in, float *g, uint32_t nframes){
+    //Parameters held locally, so stores to g cannot alias them - Same expressions as compressor_computer()
+    const float threshold = comp->threshold;
+    const float ratio = comp->ratio;
+    const float half = 0.5f * comp->knee_width;
+    const float slope = (1.0f/comp->ratio) - 1.0f;
+    const float den = 2.0f * comp->knee_width;
+    float abs, db, x, knee, above, sc;
+    uint32_t i;
+    //Convert Input Signal to dB - libm calls, independent of each other
+    for (i = 0; i < nframes; i++){
+        g[i] = lin2db(fabsf(in[i]));
+    }
+    //Gain Computer - Every region evaluated, then selected
+    //- Zero, NaN and Inf target 0dB, maintaining gs continuity as the per-sample code did
+    for (i = 0; i < nframes; i++){
+        db = g[i];
+        x = db - threshold + half;
+        knee = db + (slope * (x * x)) / den;
+        above = threshold + (db - threshold) / ratio;
+        sc = (db < (threshold + half)) ? knee : above;
+        sc = (db < (threshold - half)) ? db : sc;
+        abs = fabsf(in[i]);
+        g[i] = ((abs > 0.0f) && (abs <= FLT_MAX)) ? sc - db : 0.0f;
+    }
+}
+
+void compressor_stage_smooth(compressor_parameters *comp, float *g, uint32_t nframes){
+    //The only recurrence - att or rel follows the direction gs moves in, so it cannot be split into blocks exactly
+    const float att = comp->att;
+    const float rel = comp->rel;
+    float gs = comp->gs[0];
+    float coeff;
+    for (uint32_t i = 0; i < nframes; i++){
+        coeff = (g[i] <= gs) ? att : rel;
+        gs = (coeff * gs) + (1.0f - coeff) * g[i];
+        g[i] = gs;
+    }
+    comp->gs[0] = gs;
+    comp->gs[1] = gs;
+}
+
+void compressor_stage_apply(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, float *g, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride){
+    float abs, y;
+    uint32_t i;
+    //Convert Smoothed Gain to Linear - libm calls, independent of each other
+    for (i = 0; i < nframes; i++){
+        g[i] = db2lin(g[i]);
+    }
+    //Apply Linear Gain, Parallelisation and Gain - Zero, NaN and Inf give 0
+    for (i = 0; i < nframes; i++){
+        y = ((comps[i * stride] * in[i] * g[i]) + in[i]) * gain[i * stride];
+        abs = fabsf(in[i]);
+        out[i] = ((abs > 0.0f) && (abs <= FLT_MAX)) ? y : 0.0f;
+    }
+}
+
+static inline void below_knee(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride){
+    //Gain Computer gives 0dB for every sample (anomalies included), so gs just decays towards 0dB
+    float lin[nframes];
+    float abs, y;
+    uint32_t i;
+    if (comp->gs[0] == 0.0f){
+        //Settled - gs stays at 0dB and the linear gain is exactly 1
+        for (i = 0; i < nframes; i++){
+            y = ((comps[i * stride] * in[i]) + in[i]) * gain[i * stride];
+            abs = fabsf(in[i]);
+            out[i] = ((abs > 0.0f) && (abs <= FLT_MAX)) ? y : 0.0f;
+        }
+        comp->gs[0] = 0.0f;
+        comp->gs[1] = 0.0f;
+        return;
+    }
+    for (i = 0; i < nframes; i++){
+        lin[i] = db2lin(compressor_smoothing(comp, 0.0f));
+    }
+    for (i = 0; i < nframes; i++){
+        y = ((comps[i * stride] * in[i] * lin[i]) + in[i]) * gain[i * stride];
+        abs = fabsf(in[i]);
+        out[i] = ((abs > 0.0f) && (abs <= FLT_MAX)) ? y : 0.0f;
+    }
+}
+
+static inline void above_knee(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride){
+    //No anomalies, and every sample above the knee, so the Gain Computer is linear in dB
+    float g[nframes];
+    const float threshold = comp->threshold;
+    const float ratio = comp->ratio;
+    uint32_t i;
+    for (i = 0; i < nframes; i++){
+        g[i] = lin2db(fabsf(in[i]));
+    }
+    for (i = 0; i < nframes; i++){
+        g[i] = (threshold + (g[i] - threshold) / ratio) - g[i];
+    }
+    compressor_stage_smooth(comp, g, nframes);
+    compressor_stage_apply(in, out, g, nframes, comps, gain, stride);
+}
+
+static inline void control(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride){
+    //Gain Computer and Smoothing once per interval, on the interval's peak, with the linear gain interpolated in between
+    //- Intervals restart each block, so a period that is not a multiple ends on a shorter one
+    float abs, peak, gc, coeff, att, rel, start, lin, step, y;
+    uint32_t i, j, len;
+    for (i = 0; i < nframes; i += len){
+        len = (nframes - i < comp->control_rate) ? nframes - i : comp->control_rate;
+        att = (len == comp->control_rate) ? comp->att_hop : powf(comp->att, (float)len);
+        rel = (len == comp->control_rate) ? comp->rel_hop : powf(comp->rel, (float)len);
+        //Interval Peak - Zero, NaN and Inf are left out, as they are by the per-sample code
+        peak = 0.0f;
+        for (j = i; j < i + len; j++){
+            abs = fabsf(in[j]);
+            peak = ((abs > peak) && (abs <= FLT_MAX)) ? abs : peak;
+        }
+        gc = (peak > 0.0f) ? compressor_computer(comp, lin2db(peak)) : 0.0f;
+        coeff = (gc <= comp->gs[0]) ? att : rel;
+        comp->gs[1] = (coeff * comp->gs[0]) + (1.0f - coeff) * gc;
+        comp->gs[0] = comp->gs[1];
+        start = comp->lin;
+        lin = db2lin(comp->gs[1]);
+        step = (lin - start) / (float)len;
+        for (j = i; j < i + len; j++){
+            y = ((comps[j * stride] * in[j] * (start + step * (float)(j - i + 1))) + in[j]) * gain[j * stride];
+            abs = fabsf(in[j]);
+            out[j] = ((abs > 0.0f) && (abs <= FLT_MAX)) ? y : 0.0f;
+        }
+        comp->lin = lin;
+    }
+}
+
+void compressor_block(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, uint32_t nframes, const float *comps, const float *gain, const uint32_t stride){
+    float abs;
+    if (comp->control_rate > 1){
+        control(in, out, comp, nframes, comps, gain, stride);
+        return;
+    }
+    //Block Pre-Classification - lin2db is monotonic, so the block peak and floor bound every sample's level
+    float peak = 0.0f, least = FLT_MAX;
+    uint32_t anomaly = 0;
+    for (uint32_t i = 0; i < nframes; i++){
+        abs = fabsf(in[i]);
+        peak = (abs > peak) ? abs : peak;
+        least = (abs < least) ? abs : least;
+        anomaly |= !(abs <= FLT_MAX);
+    }
+    if (lin2db(peak) < (comp->threshold - 0.5f * comp->knee_width)){
+        below_knee(in, out, comp, nframes, comps, gain, stride);
+        return;
+    }
+    if (!anomaly && (lin2db(least) >= (comp->threshold + 0.5f * comp->knee_width))){
+        above_knee(in, out, comp, nframes, comps, gain, stride);
+        return;
+    }
+    //Mixed Block - Staged, so only the smoothing runs sample by sample
+    float g[nframes];
+    compressor_stage_curve(comp, in, g, nframes);
+    compressor_stage_smooth(comp, g, nframes);
+    compressor_stage_apply(in, out, g, nframes, comps, gain, stride);
 }
 
 int compressor(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, interface_parameters *inter){
-    float abs, db, sc, gc, lin;
-    for (uint32_t i = 0; i < inter->nframes; i++){
+    //Settled Parameters - No ramp work at all
+    if (ramp_settled(&comp->comps_ramp) && ramp_settled(&comp->gain_ramp)){
+        compressor_block(in, out, comp, inter->nframes, &comp->comps, &comp->gain, 0);
+        return 0;
+    }
+    float comps[inter->nframes];
+    float gain[inter->nframes];
+    ramp_block(&comp->comps_ramp, comps, inter->nframes);
+    ramp_block(&comp->gain_ramp, gain, inter->nframes);
+    comp->comps = comp->comps_ramp.current;
+    comp->gain = comp->gain_ramp.current;
+    compressor_block(in, out, comp, inter->nframes, comps, gain, 1);
+    return 0;
+}
+
+void compressor_set(compressor_parameters *comp, float compression_db, float gain_db){
+    comp->compression_db = compression_db;
+    comp->gain_db = gain_db;
+    TRACE_INSTANT("compressor_set");
+    //Ramp from wherever the previous change had reached
+    ramp_set(&comp->comps_ramp, comp->comps, db2lin(compression_db) - 1.0f);
+    ramp_set(&comp->gain_ramp, comp->gain, db2lin(gain_db));
+}
+
+size_t compressor_state_size(compressor_parameters *comp){
+    return sizeof(compressor_state);
+}
+
+void compressor_snapshot(compressor_parameters *comp, void *buffer){
+    compressor_state *state = (compressor_state*)buffer;
+    state->gs[0] = comp->gs[0];
+    state->gs[1] = comp->gs[1];
+    state->lin = comp->lin;
+    state->comps = comp->comps;
+    state->gain = comp->gain;
+    state->comps_ramp = comp->comps_ramp;
+    state->gain_ramp = comp->gain_ramp;
+    state->compression_db = comp->compression_db;
+    state->gain_db = comp->gain_db;
+}
+
+int compressor_restore(compressor_parameters *comp, const void *buffer){
+    const compressor_state *state = (const compressor_state*)buffer;
+    comp->gs[0] = state->gs[0];
+    comp->gs[1] = state->gs[1];
+    comp->lin = state->lin;
+    comp->comps = state->comps;
+    comp->gain = state->gain;
+    comp->comps_ramp = state->comps_ramp;
+    comp->gain_ramp = state->gain_ramp;
+    comp->compression_db = state->compression_db;
+    comp->gain_db = state->gain_db;
+    return 0;
+}
+
+void compressor_sweep_default(compressor_sweep_parameters *sweep, compressor_parameters *comp){
+    //Copy Parameters into Every Lane
+    uint32_t k;
+    for (k = 0; k < SWEEP_LANES; k++){
+        sweep->ratio[k] = comp->ratio;
+        sweep->knee_width[k] = comp->knee_width;
+        sweep->threshold[k] = comp->threshold;
+        sweep->attack_t[k] = comp->attack_t;
+        sweep->release_t[k] = comp->release_t;
+        sweep->compression_db[k] = comp->compression_db;
+        sweep->gain_db[k] = comp->gain_db;
+        sweep->gs[k] = comp->gs[0];
+    }
+    sweep->lanes = SWEEP_LANES;
+}
+
+void compressor_sweep_init(compressor_sweep_parameters *sweep, interface_parameters *inter){
+    //Parameter Initialisation - Same expressions as compressor_init(), one per lane
+    compressor_parameters lane;
+    uint32_t k;
+    for (k = 0; k < SWEEP_LANES; k++){
+        //Every field compressor_init() reads is defined, then the lane's own values set
+        compressor_default(&lane);
+        lane.ratio = sweep->ratio[k];
+        lane.knee_width = sweep->knee_width[k];
+        lane.threshold = sweep->threshold[k];
+        lane.attack_t = sweep->attack_t[k];
+        lane.release_t = sweep->release_t[k];
+        lane.compression_db = sweep->compression_db[k];
+        lane.gain_db = sweep->gain_db[k];
+        compressor_init(&lane, inter);
+        sweep->comps[k] = lane.comps;
+        sweep->gain[k] = lane.gain;
+        sweep->att[k] = lane.att;
+        sweep->rel[k] = lane.rel;
+        sweep->knee_lo[k] = sweep->threshold[k] - 0.5f * sweep->knee_width[k];
+        sweep->knee_hi[k] = sweep->threshold[k] + 0.5f * sweep->knee_width[k];
+        sweep->knee_slope[k] = (1.0f/sweep->ratio[k]) - 1.0f;
+        sweep->knee_den[k] = 2.0f * sweep->knee_width[k];
+    }
+    //Variants that only differ in compression or gain share one gain computer
+    sweep->shared_curve = 1;
+    for (k = 1; k < sweep->lanes; k++){
+        if ((sweep->ratio[k] != sweep->ratio[0]) || (sweep->knee_width[k] != sweep->knee_width[0]) ||
+            (sweep->threshold[k] != sweep->threshold[0]) || (sweep->att[k] != sweep->att[0]) ||
+            (sweep->rel[k] != sweep->rel[0]) || (sweep->gs[k] != sweep->gs[0])){
+            sweep->shared_curve = 0;
+        }
+    }
+}
+
+int compressor_sweep(jack_default_audio_sample_t *in, jack_default_audio_sample_t **out, compressor_sweep_parameters *sweep, interface_parameters *inter){
+    float abs, db, x, knee, above, sc, gc, att, rel, coeff;
+    float lin[SWEEP_LANES];
+    //Shared curves only need the first lane computed
+    uint32_t curves = sweep->shared_curve ? 1 : SWEEP_LANES;
+    uint32_t i, k;
+    for (i = 0; i < inter->nframes; i++){
         //Anomaly Detection
         abs = fabsf(in[i]);
         if ((abs == 0.0f) || (isnan(abs)) || (isinf(abs))){
-            out[i] = 0.0f;
-            gc = 0.0f;
             //Maintain gs continuity when anomaly detected
-            if (gc <= comp->gs[0]){
-                comp->gs[1] = (comp->att * comp->gs[0]);
+            for (k = 0; k < curves; k++){
+                att = sweep->att[k];
+                rel = sweep->rel[k];
+                coeff = (0.0f <= sweep->gs[k]) ? att : rel;
+                sweep->gs[k] = coeff * sweep->gs[k];
             }
-            else if (gc > comp->gs[0]){
-                comp->gs[1] = (comp->rel * comp->gs[0]);
-            }
-            else{
-                comp->gs[1] = (comp->att * comp->gs[0]);
-                fprintf(stderr, "[ERROR] in Anomaly Gain Smoothing\n");
-                return 1;
+            for (k = 0; k < sweep->lanes; k++){
+                out[k][i] = 0.0f;
             }
+            continue;
         }
-        //If No Anomalies Detected
-        else{
-            //Convert Input Signal to dB
-            db = lin2db(abs);
-            //Gain Computer
-            if (db < (comp->threshold - 0.5f * comp->knee_width)){
-                sc = db;
-            }
-            else if ((db >= (comp->threshold - 0.5f * comp->knee_width)) &&
-                     (db < (comp->threshold + 0.5f * comp->knee_width))){
-                sc = db + (((1.0f/comp->ratio) - 1.0f) *
-                     powf((db - comp->threshold + 0.5f * comp->knee_width), 2.0f)) /
-                     (2.0f * comp->knee_width);
-            }
-            else if (db >= (comp->threshold + 0.5f * comp->knee_width)){
-                sc = comp->threshold + (db - comp->threshold) / comp->ratio;
-            }
-            else{
-                sc = db;
-                fprintf(stderr, "[ERROR] in Gain Computer\n");
-                return 1;
-            }
+        //Convert Input Signal to dB - Once for all variants
+        db = lin2db(abs);
+        //Gain Computer and Gain Smoothing - Every region evaluated, then selected across lanes
+        for (k = 0; k < curves; k++){
+            x = db - sweep->threshold[k] + 0.5f * sweep->knee_width[k];
+            knee = db + (sweep->knee_slope[k] * (x * x)) / sweep->knee_den[k];
+            above = sweep->threshold[k] + (db - sweep->threshold[k]) / sweep->ratio[k];
+            sc = (db < sweep->knee_hi[k]) ? knee : above;
+            sc = (db < sweep->knee_lo[k]) ? db : sc;
             gc = sc - db;
-            //Gain Smoothing
-            if (gc <= comp->gs[0]){
-                comp->gs[1] = (comp->att * comp->gs[0]) + (1.0f - comp->att) * gc;
-            }
-            else if (gc > comp->gs[0]){
-                comp->gs[1] = (comp->rel * comp->gs[0]) + (1.0f - comp->rel) * gc;
-            }
-            else{
-                comp->gs[1] = (comp->att * comp->gs[0]) + (1.0f - comp->att) * gc;
-                fprintf(stderr, "[ERROR] in Gain Smoothing\n");
-                return 1;
-            }
-            //Apply Linear Gain and Parallelisation
-            lin = db2lin(comp->gs[1]);
-            out[i] = (comp->comps * in[i] * lin) + in[i];
-            //Apply Gain
-            out[i] *= comp->gain;
+            att = sweep->att[k];
+            rel = sweep->rel[k];
+            coeff = (gc <= sweep->gs[k]) ? att : rel;
+            sweep->gs[k] = (coeff * sweep->gs[k]) + (1.0f - coeff) * gc;
         }
-        comp->gs[0] = comp->gs[1];
+        //Convert Smoothed Gain to Linear
+        for (k = 0; k < curves; k++){
+            lin[k] = db2lin(sweep->gs[k]);
+        }
+        for (k = curves; k < sweep->lanes; k++){
+            lin[k] = lin[0];
+        }
+        //Apply Linear Gain, Parallelisation and Gain
+        for (k = 0; k < sweep->lanes; k++){
+            out[k][i] = (sweep->comps[k] * in[i] * lin[k]) + in[i];
+            out[k][i] *= sweep->gain[k];
+        }
+    }
+    //Keep shared lanes in step with the first
+    for (k = curves; k < SWEEP_LANES; k++){
+        sweep->gs[k] = sweep->gs[0];
     }
     return 0;
 }
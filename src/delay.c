@@ -0,0 +1,224 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include "delay.h"
+#include "trace.h"
+
+static inline float db2lin(float db){
+    return powf(10.0f, 0.05f * db);
+}
+
+static inline uint32_t tap_samples(delay_parameters *dly, uint32_t tap, float spacing, interface_parameters *inter){
+    //Tap Time in frames, kept at least a period old so each block can be read before it is written
+    float t = (float)(tap + 1) * spacing * (float)inter->fs + 0.5f;
+    uint32_t d = (t > 0.0f) ? (uint32_t)t : 0;
+    uint32_t longest = dly->mask + 1 - inter->nframes;
+    if (d < inter->nframes){
+        d = inter->nframes;
+    }
+    else if (d > longest){
+        d = longest;
+    }
+    return d;
+}
+
+static inline uint32_t ring_length(uint32_t fs, uint32_t nframes){
+    //Smallest power of two holding DELAY_MAX_T plus a period
+    uint32_t length = 1;
+    while (length < (uint32_t)(DELAY_MAX_T * (float)fs) + nframes){
+        length <<= 1;
+    }
+    return length;
+}
+
+static inline float tap_spacing(delay_parameters *dly){
+    //Tempo-synced spacing when a tempo is set, then limited so the last tap fits in DELAY_MAX_T
+    float spacing = (dly->tempo > 0.0f) ? (60.0f / dly->tempo) * dly->beats : dly->time_t;
+    if (spacing * (float)dly->taps > DELAY_MAX_T){
+        spacing = DELAY_MAX_T / (float)dly->taps;
+    }
+    return spacing;
+}
+
+void delay_default(delay_parameters *dly){
+    //Set Default Parameters
+    dly->time_t = 0.375f;
+    dly->tempo = 0.0f;
+    dly->beats = 1.0f;
+    dly->taps = 2;
+    dly->feedback = 0.35f;
+    dly->damping = 0.3f;
+    dly->mix = 0.4f;
+    dly->gain_db = 0.0f;
+    dly->chain = 0;
+    dly->ring = NULL;
+    dly->write_pos = 0;
+    dly->lp = 0.0f;
+}
+
+int delay_init(delay_parameters *dly, interface_parameters *inter){
+    //Parameter Initialisation
+    dly->gain = db2lin(dly->gain_db);
+    dly->damp_coeff = 1.0f - 0.9f * dly->damping;
+    uint32_t k;
+    for (k = 0; k < DELAY_MAX_TAPS; k++){
+        //Later taps are quieter
+        dly->tap_level[k] = (k < dly->taps) ? (float)(dly->taps - k) / (float)dly->taps : 0.0f;
+    }
+    //Ring Buffer - Allocated for the highest sample rate and largest period, so JACK can change either live
+    uint32_t fs = (inter->fs > INTERFACE_MAX_FS) ? inter->fs : INTERFACE_MAX_FS;
+    uint32_t nframes = (inter->nframes > INTERFACE_MAX_NFRAMES) ? inter->nframes : INTERFACE_MAX_NFRAMES;
+    dly->capacity = ring_length(fs, nframes);
+    dly->ring = (float*)sample_alloc((size_t)dly->capacity * sizeof(float));
+    if (dly->ring == NULL){
+        fprintf(stderr, "[ERROR] in dly->ring memory allocation\n");
+        return 1;
+    }
+    memset(dly->ring, 0, (size_t)dly->capacity * sizeof(float));
+    dly->mask = 0;
+    dly->fs = 0;
+    delay_update(dly, inter);
+    return 0;
+}
+
+void delay_update(delay_parameters *dly, interface_parameters *inter){
+    //Only the part of the ring needed at this rate and period is used
+    uint32_t mask = ring_length(inter->fs, inter->nframes) - 1;
+    if ((mask != dly->mask) || (inter->fs != dly->fs)){
+        memset(dly->ring, 0, (size_t)(mask + 1) * sizeof(float));
+        dly->mask = mask;
+        dly->fs = inter->fs;
+        dly->write_pos = 0;
+        dly->lp = 0.0f;
+    }
+    //Tap Times - Settled, no crossfade pending
+    float spacing = tap_spacing(dly);
+    uint32_t k;
+    for (k = 0; k < DELAY_MAX_TAPS; k++){
+        dly->tap_to[k] = tap_samples(dly, k, spacing, inter);
+        dly->tap_from[k] = dly->tap_to[k];
+        dly->tap_next[k] = dly->tap_to[k];
+        dly->tap_fade[k] = DELAY_FADE;
+    }
+}
+
+void delay_set_time(delay_parameters *dly, float time_t, float tempo, interface_parameters *inter){
+    dly->time_t = time_t;
+    dly->tempo = tempo;
+    TRACE_INSTANT("delay_set_time");
+    float spacing = tap_spacing(dly);
+    uint32_t k, d;
+    for (k = 0; k < DELAY_MAX_TAPS; k++){
+        d = tap_samples(dly, k, spacing, inter);
+        if (dly->tap_fade[k] < DELAY_FADE){
+            //Mid-Crossfade - Restarting it would jump the read, so the new time waits for it to end
+            dly->tap_next[k] = d;
+        }
+        else if (d != dly->tap_to[k]){
+            dly->tap_from[k] = dly->tap_to[k];
+            dly->tap_to[k] = d;
+            dly->tap_next[k] = d;
+            dly->tap_fade[k] = 0;
+        }
+    }
+}
+
+size_t delay_state_size(delay_parameters *dly){
+    return sizeof(delay_state) + (size_t)dly->capacity * sizeof(float);
+}
+
+void delay_snapshot(delay_parameters *dly, void *buffer){
+    delay_state *state = (delay_state*)buffer;
+    state->time_t = dly->time_t;
+    state->tempo = dly->tempo;
+    state->mask = dly->mask;
+    state->fs = dly->fs;
+    state->write_pos = dly->write_pos;
+    memcpy(state->tap_from, dly->tap_from, sizeof(state->tap_from));
+    memcpy(state->tap_to, dly->tap_to, sizeof(state->tap_to));
+    memcpy(state->tap_next, dly->tap_next, sizeof(state->tap_next));
+    memcpy(state->tap_fade, dly->tap_fade, sizeof(state->tap_fade));
+    state->lp = dly->lp;
+    memcpy(state + 1, dly->ring, (size_t)(dly->mask + 1) * sizeof(float));
+}
+
+int delay_restore(delay_parameters *dly, const void *buffer){
+    const delay_state *state = (const delay_state*)buffer;
+    //Same Ring Length - A snapshot taken at another rate or period holds taps this instance cannot place
+    if (state->mask != dly->mask){
+        return 1;
+    }
+    dly->time_t = state->time_t;
+    dly->tempo = state->tempo;
+    dly->fs = state->fs;
+    dly->write_pos = state->write_pos;
+    memcpy(dly->tap_from, state->tap_from, sizeof(dly->tap_from));
+    memcpy(dly->tap_to, state->tap_to, sizeof(dly->tap_to));
+    memcpy(dly->tap_next, state->tap_next, sizeof(dly->tap_next));
+    memcpy(dly->tap_fade, state->tap_fade, sizeof(dly->tap_fade));
+    dly->lp = state->lp;
+    memcpy(dly->ring, state + 1, (size_t)(dly->mask + 1) * sizeof(float));
+    return 0;
+}
+
+int delay(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, delay_parameters *dly, interface_parameters *inter){
+    float wet[inter->nframes];
+    float repeat[inter->nframes];
+    float *ring = dly->ring;
+    float f, x;
+    const float step = 1.0f / (float)DELAY_FADE;
+    uint32_t mask = dly->mask;
+    uint32_t i, k, r0, r1;
+    for (i = 0; i < inter->nframes; i++){
+        wet[i] = 0.0f;
+    }
+    //Read Taps - Every tap is at least a period old, so the whole block can be read up front
+    for (k = 0; k < dly->taps; k++){
+        r0 = dly->write_pos - dly->tap_from[k];
+        r1 = dly->write_pos - dly->tap_to[k];
+        if (dly->tap_fade[k] < DELAY_FADE){
+            //Crossfade from the old tap time to the new one
+            for (i = 0; i < inter->nframes; i++){
+                f = fminf((float)(dly->tap_fade[k] + i + 1) * step, 1.0f);
+                repeat[i] = (1.0f - f) * ring[(r0 + i) & mask] + f * ring[(r1 + i) & mask];
+            }
+            dly->tap_fade[k] += inter->nframes;
+            if (dly->tap_fade[k] >= DELAY_FADE){
+                dly->tap_fade[k] = DELAY_FADE;
+                dly->tap_from[k] = dly->tap_to[k];
+                //Queued Tap Time - Fades in from the next block, starting at the read just settled on
+                if (dly->tap_next[k] != dly->tap_to[k]){
+                    dly->tap_to[k] = dly->tap_next[k];
+                    dly->tap_fade[k] = 0;
+                }
+            }
+        }
+        else{
+            for (i = 0; i < inter->nframes; i++){
+                repeat[i] = ring[(r1 + i) & mask];
+            }
+        }
+        for (i = 0; i < inter->nframes; i++){
+            wet[i] += dly->tap_level[k] * repeat[i];
+        }
+    }
+    //Write Input and Damped Feedback from the last tap
+    for (i = 0; i < inter->nframes; i++){
+        dly->lp += dly->damp_coeff * (repeat[i] - dly->lp);
+        x = in[i] + dly->feedback * dly->lp;
+        //Anomaly Detection - NaN or Inf would recirculate forever
+        ring[(dly->write_pos + i) & mask] = (fabsf(x) <= FLT_MAX) ? x : 0.0f;
+    }
+    dly->write_pos = (dly->write_pos + inter->nframes) & mask;
+    //Mix and Gain - NaN and Inf inputs give a dry 0, as in the other effects
+    for (i = 0; i < inter->nframes; i++){
+        x = (fabsf(in[i]) <= FLT_MAX) ? in[i] : 0.0f;
+        out[i] = (x + dly->mix * wet[i]) * dly->gain;
+    }
+    return 0;
+}
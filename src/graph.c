@@ -0,0 +1,663 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <float.h>
+#include <math.h>
+#include "graph.h"
+#include "logger.h"
+#include "trace.h"
+
+#define PI 3.14159265f
+#define GRAPH_LINE 256          //Longest Line in a graph description
+
+static const char *type_names[8] = {"in", "compressor", "overdrive", "delay", "octaver", "lowpass", "highpass", "mix"};
+
+typedef struct{
+    //Graph Description Parameter - Written at offset into the node's effect parameters
+    const char *key;
+    uint32_t type;
+    size_t offset;
+    uint32_t integer;
+    float min, max;
+    uint32_t above;     //Set when the value must be more than min, not at least min - As the main program checks it
+} graph_key;
+
+//Same names and ranges as the main program's arguments
+static const graph_key keys[] = {
+    {"ratio", GRAPH_COMPRESSOR, offsetof(compressor_parameters, ratio), 0, 20.0f, FLT_MAX, 1},
+    {"knee_width", GRAPH_COMPRESSOR, offsetof(compressor_parameters, knee_width), 0, 0.0f, FLT_MAX, 0},
+    {"threshold", GRAPH_COMPRESSOR, offsetof(compressor_parameters, threshold), 0, -FLT_MAX, 0.0f, 0},
+    {"attack_t", GRAPH_COMPRESSOR, offsetof(compressor_parameters, attack_t), 0, 0.0f, FLT_MAX, 0},
+    {"release_t", GRAPH_COMPRESSOR, offsetof(compressor_parameters, release_t), 0, 0.025f, FLT_MAX, 0},
+    {"compression_db", GRAPH_COMPRESSOR, offsetof(compressor_parameters, compression_db), 0, 0.0f, FLT_MAX, 0},
+    {"gain_db", GRAPH_COMPRESSOR, offsetof(compressor_parameters, gain_db), 0, -FLT_MAX, FLT_MAX, 0},
+    {"control_rate", GRAPH_COMPRESSOR, offsetof(compressor_parameters, control_rate), 1, 1.0f, (float)COMPRESSOR_MAX_RATE, 0},
+    {"drive", GRAPH_OVERDRIVE, offsetof(overdrive_parameters, drive), 0, 0.0f, 1.0f, 0},
+    {"window_t", GRAPH_OVERDRIVE, offsetof(overdrive_parameters, window_t), 0, 0.0f, 59.0f, 1},
+    {"gain_db", GRAPH_OVERDRIVE, offsetof(overdrive_parameters, gain_db), 0, -FLT_MAX, FLT_MAX, 0},
+    {"time_t", GRAPH_DELAY, offsetof(delay_parameters, time_t), 0, 0.0f, DELAY_MAX_T, 0},
+    {"tempo", GRAPH_DELAY, offsetof(delay_parameters, tempo), 0, 0.0f, FLT_MAX, 0},
+    {"beats", GRAPH_DELAY, offsetof(delay_parameters, beats), 0, 0.0f, FLT_MAX, 1},
+    {"taps", GRAPH_DELAY, offsetof(delay_parameters, taps), 1, 1.0f, (float)DELAY_MAX_TAPS, 0},
+    {"feedback", GRAPH_DELAY, offsetof(delay_parameters, feedback), 0, 0.0f, 0.95f, 0},
+    {"damping", GRAPH_DELAY, offsetof(delay_parameters, damping), 0, 0.0f, 1.0f, 0},
+    {"mix", GRAPH_DELAY, offsetof(delay_parameters, mix), 0, 0.0f, 1.0f, 0},
+    {"gain_db", GRAPH_DELAY, offsetof(delay_parameters, gain_db), 0, -FLT_MAX, FLT_MAX, 0},
+    {"sub_level", GRAPH_OCTAVER, offsetof(octaver_parameters, sub_level), 0, 0.0f, 1.0f, 0},
+    {"dry_level", GRAPH_OCTAVER, offsetof(octaver_parameters, dry_level), 0, 0.0f, 1.0f, 0},
+    {"tracking", GRAPH_OCTAVER, offsetof(octaver_parameters, tracking), 0, 1.0f, 8.0f, 0},
+    {"quality", GRAPH_OCTAVER, offsetof(octaver_parameters, quality), 1, 0.0f, 1.0f, 0},
+    {"gain_db", GRAPH_OCTAVER, offsetof(octaver_parameters, gain_db), 0, -FLT_MAX, FLT_MAX, 0},
+};
+
+static inline int find(graph_parameters *graph, const char *name){
+    for (uint32_t v = 0; v < graph->nnodes; v++){
+        if (strcmp(graph->nodes[v].name, name) == 0){
+            return (int)v;
+        }
+    }
+    return -1;
+}
+
+//Advance Overdrive Window Counters, as process() does for a serial chain
+static inline void advance(overdrive_parameters *drive){
+    drive->peak_count++;
+    drive->buffer_count++;
+    if (drive->buffer_count == drive->peak_window){
+        drive->buffer_count = 0;
+    }
+}
+
+static inline float *buffer(graph_parameters *graph, uint32_t b, jack_default_audio_sample_t *in, jack_default_audio_sample_t *out){
+    if (b == GRAPH_IN_BUFFER){
+        return in;
+    }
+    if (b == GRAPH_OUT_BUFFER){
+        return out;
+    }
+    return &graph->scratch[(size_t)(b - 2) * INTERFACE_MAX_NFRAMES];
+}
+
+static inline void filter_coeffs(graph_node *node, interface_parameters *inter){
+    //Butterworth Section (Q = 1/sqrt(2)) - b0, b1, b2, a1, a2 normalised by a0
+    float w = 2.0f * PI * node->cutoff / (float)inter->fs;
+    float alpha = sinf(w) / (2.0f * 0.7071068f);
+    float a0 = 1.0f + alpha;
+    float c = cosf(w);
+    if (node->type == GRAPH_LOWPASS){
+        node->coeffs[0] = 0.5f * (1.0f - c) / a0;
+        node->coeffs[1] = (1.0f - c) / a0;
+    }
+    else{
+        node->coeffs[0] = 0.5f * (1.0f + c) / a0;
+        node->coeffs[1] = -(1.0f + c) / a0;
+    }
+    node->coeffs[2] = node->coeffs[0];
+    node->coeffs[3] = -2.0f * c / a0;
+    node->coeffs[4] = (1.0f - alpha) / a0;
+}
+
+static inline void filter(float *in, float *out, graph_node *node, uint32_t nframes){
+    //Transposed Direct Form II
+    float *c = node->coeffs;
+    float z0 = node->z[0], z1 = node->z[1], x, y;
+    for (uint32_t i = 0; i < nframes; i++){
+        x = in[i];
+        y = c[0] * x + z0;
+        z0 = c[1] * x - c[3] * y + z1;
+        z1 = c[2] * x - c[4] * y;
+        out[i] = y;
+    }
+    //Anomaly Detection - NaN or Inf would stay in the state forever
+    node->z[0] = (fabsf(z0) <= FLT_MAX) ? z0 : 0.0f;
+    node->z[1] = (fabsf(z1) <= FLT_MAX) ? z1 : 0.0f;
+}
+
+static inline int set_key(graph_node *node, const char *key, const char *value, uint32_t line){
+    float valid;
+    char err;
+    //Node Parameters
+    if (strcmp(key, "bypass") == 0){
+        if ((sscanf(value, "%f %c", &valid, &err) != 1) || ((valid != 0.0f) && (valid != 1.0f))){
+            printf("[USER-ERROR] Invalid value '%s' for '%s' on line %u of graph\n", value, key, line);
+            return 1;
+        }
+        node->bypass = (uint32_t)valid;
+        return 0;
+    }
+    if ((strcmp(key, "cutoff") == 0) && ((node->type == GRAPH_LOWPASS) || (node->type == GRAPH_HIGHPASS))){
+        if ((sscanf(value, "%f %c", &valid, &err) != 1) || (valid < 20.0f) || (valid > 20000.0f)){
+            printf("[USER-ERROR] Invalid value '%s' for '%s' on line %u of graph\n", value, key, line);
+            return 1;
+        }
+        node->cutoff = valid;
+        return 0;
+    }
+    if ((strcmp(key, "levels") == 0) && (node->type == GRAPH_MIX)){
+        char list[GRAPH_LINE];
+        uint32_t k = 0;
+        snprintf(list, GRAPH_LINE, "%s", value);
+        for (char *level = strtok(list, ","); level != NULL; level = strtok(NULL, ",")){
+            if ((k == node->ninputs) || (sscanf(level, "%f %c", &valid, &err) != 1)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s' on line %u of graph - Needs one level per input\n", value, key, line);
+                return 1;
+            }
+            node->levels[k++] = valid;
+        }
+        if (k != node->ninputs){
+            printf("[USER-ERROR] Invalid value '%s' for '%s' on line %u of graph - Needs one level per input\n", value, key, line);
+            return 1;
+        }
+        return 0;
+    }
+    //Effect Parameters
+    int found = (sscanf(value, "%f %c", &valid, &err) == 1) ? graph_parameter(node->type, node->effect, key, valid) : 1;
+    if (found == 1){
+        printf("[USER-ERROR] Invalid value '%s' for '%s' on line %u of graph\n", value, key, line);
+        return 1;
+    }
+    if (found == 2){
+        printf("[USER-ERROR] Unknown parameter '%s' for %s on line %u of graph\n", key, type_names[node->type], line);
+        return 1;
+    }
+    return 0;
+}
+
+static inline int create_effect(graph_node *node, interface_parameters *inter){
+    switch (node->type){
+        case GRAPH_COMPRESSOR:
+            compressor_init((compressor_parameters*)node->effect, inter);
+            return 0;
+        case GRAPH_OVERDRIVE:
+            return overdrive_init((overdrive_parameters*)node->effect, inter);
+        case GRAPH_DELAY:
+            return delay_init((delay_parameters*)node->effect, inter);
+        case GRAPH_OCTAVER:
+            octaver_init((octaver_parameters*)node->effect, inter);
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+int graph_parameter(uint32_t type, void *effect, const char *key, float value){
+    for (uint32_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++){
+        if ((keys[k].type == type) && (strcmp(keys[k].key, key) == 0)){
+            if (!(value >= keys[k].min) || (keys[k].above && (value == keys[k].min)) || (value > keys[k].max)){
+                return 1;
+            }
+            char *field = (char*)effect + keys[k].offset;
+            if (keys[k].integer){
+                *(uint32_t*)field = (uint32_t)value;
+            }
+            else{
+                *(float*)field = value;
+            }
+            return 0;
+        }
+    }
+    return 2;
+}
+
+void graph_default(graph_parameters *graph){
+    //Set Default Parameters
+    memset(graph->nodes, 0, sizeof(graph->nodes));
+    snprintf(graph->nodes[0].name, GRAPH_NAME, "in");
+    graph->nodes[0].type = GRAPH_INPUT;
+    graph->nnodes = 1;
+    graph->output_name[0] = '\0';
+    graph->subblock = 0;
+    graph->nsteps = 0;
+    graph->nbuffers = 2;
+    graph->scratch = NULL;
+}
+
+int graph_add(graph_parameters *graph, const char *name, uint32_t type, const char *inputs, void *effect){
+    if (graph->nnodes == GRAPH_MAX_NODES){
+        printf("[USER-ERROR] Graph can have at most %u nodes\n", GRAPH_MAX_NODES);
+        return 1;
+    }
+    if ((strlen(name) == 0) || (strlen(name) >= GRAPH_NAME) || (find(graph, name) >= 0) || (strcmp(name, "output") == 0)){
+        printf("[USER-ERROR] Invalid or repeated node name '%s'\n", name);
+        return 1;
+    }
+    if ((type == GRAPH_INPUT) || (type > GRAPH_MIX) || ((type <= GRAPH_OCTAVER) && (effect == NULL))){
+        fprintf(stderr, "[ERROR] in graph node '%s' type\n", name);
+        return 1;
+    }
+    graph_node *node = &graph->nodes[graph->nnodes];
+    memset(node, 0, sizeof(graph_node));
+    snprintf(node->name, GRAPH_NAME, "%s", name);
+    node->type = type;
+    node->effect = effect;
+    node->cutoff = 250.0f;
+    //Inputs - Resolved when compiled, so may name nodes added later
+    char list[GRAPH_LINE];
+    snprintf(list, GRAPH_LINE, "%s", inputs);
+    for (char *input = strtok(list, ","); input != NULL; input = strtok(NULL, ",")){
+        if ((node->ninputs == GRAPH_MAX_INPUTS) || (strlen(input) >= GRAPH_NAME)){
+            printf("[USER-ERROR] Too many or invalid inputs for node '%s'\n", name);
+            return 1;
+        }
+        node->levels[node->ninputs] = 1.0f;
+        snprintf(node->input_names[node->ninputs++], GRAPH_NAME, "%s", input);
+    }
+    if ((node->ninputs == 0) || ((type != GRAPH_MIX) && (node->ninputs != 1))){
+        printf("[USER-ERROR] Node '%s' needs %s\n", name, (type == GRAPH_MIX) ? "at least one input" : "exactly one input");
+        return 1;
+    }
+    graph->nnodes++;
+    return 0;
+}
+
+int graph_load(graph_parameters *graph, const char *path, interface_parameters *inter){
+    FILE *file = fopen(path, "r");
+    if (file == NULL){
+        printf("[USER-ERROR] Cannot open graph '%s'\n", path);
+        return 1;
+    }
+    static const size_t sizes[5] = {0, sizeof(compressor_parameters), sizeof(overdrive_parameters), sizeof(delay_parameters), sizeof(octaver_parameters)};
+    char line[GRAPH_LINE];
+    char *tokens[GRAPH_LINE / 2];
+    uint32_t number = 0, ntokens, type, k;
+    while (fgets(line, GRAPH_LINE, file) != NULL){
+        number++;
+        //Strip Comments, then Split on Whitespace
+        char *comment = strchr(line, '#');
+        if (comment != NULL){
+            *comment = '\0';
+        }
+        ntokens = 0;
+        for (char *token = strtok(line, " \t\r\n"); token != NULL; token = strtok(NULL, " \t\r\n")){
+            tokens[ntokens++] = token;
+        }
+        if (ntokens == 0){
+            continue;
+        }
+        //output <name>
+        if (strcmp(tokens[0], "output") == 0){
+            if ((ntokens != 2) || (strlen(tokens[1]) >= GRAPH_NAME)){
+                printf("[USER-ERROR] Expected 'output <name>' on line %u of graph\n", number);
+                fclose(file);
+                return 1;
+            }
+            snprintf(graph->output_name, GRAPH_NAME, "%s", tokens[1]);
+            continue;
+        }
+        //<name> <type> <input>[,<input>...] [parameter=value ...]
+        if (ntokens < 3){
+            printf("[USER-ERROR] Expected '<name> <type> <inputs> [parameter=value ...]' on line %u of graph\n", number);
+            fclose(file);
+            return 1;
+        }
+        for (type = GRAPH_COMPRESSOR; type <= GRAPH_MIX; type++){
+            if (strcmp(tokens[1], type_names[type]) == 0){
+                break;
+            }
+        }
+        if (type > GRAPH_MIX){
+            printf("[USER-ERROR] Unknown node type '%s' on line %u of graph\n", tokens[1], number);
+            fclose(file);
+            return 1;
+        }
+        //Effect Parameters - Defaults, then the line's values, then initialised
+        void *effect = NULL;
+        if (type <= GRAPH_OCTAVER){
+            effect = sample_alloc(sizes[type]);
+            if (effect == NULL){
+                fprintf(stderr, "[ERROR] in graph effect memory allocation\n");
+                fclose(file);
+                return 1;
+            }
+            if (type == GRAPH_COMPRESSOR){
+                compressor_default((compressor_parameters*)effect);
+            }
+            else if (type == GRAPH_OVERDRIVE){
+                overdrive_default((overdrive_parameters*)effect);
+            }
+            else if (type == GRAPH_DELAY){
+                delay_default((delay_parameters*)effect);
+            }
+            else{
+                octaver_default((octaver_parameters*)effect);
+            }
+        }
+        if (graph_add(graph, tokens[0], type, tokens[2], effect)){
+            printf("[USER-ERROR] in node on line %u of graph\n", number);
+            free(effect);
+            fclose(file);
+            return 1;
+        }
+        graph_node *node = &graph->nodes[graph->nnodes - 1];
+        node->owned = (effect != NULL);
+        for (k = 3; k < ntokens; k++){
+            char *value = strchr(tokens[k], '=');
+            if (value == NULL){
+                printf("[USER-ERROR] Expected 'parameter=value' for '%s' on line %u of graph\n", tokens[k], number);
+                fclose(file);
+                return 1;
+            }
+            *value++ = '\0';
+            if (set_key(node, tokens[k], value, number)){
+                fclose(file);
+                return 1;
+            }
+        }
+        if (create_effect(node, inter)){
+            fprintf(stderr, "[ERROR] in graph node '%s' initialisation\n", node->name);
+            fclose(file);
+            return 1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+int graph_compile(graph_parameters *graph, interface_parameters *inter){
+    uint32_t order[GRAPH_MAX_NODES], last_use[GRAPH_MAX_NODES], buffers[GRAPH_MAX_NODES];
+    uint32_t live[GRAPH_MAX_NODES], done[GRAPH_MAX_NODES];
+    uint32_t free_list[GRAPH_MAX_NODES], nfree = 0;
+    uint32_t v, k, t, norder = 0;
+    int u;
+    //Resolve Input Names
+    for (v = 1; v < graph->nnodes; v++){
+        graph_node *node = &graph->nodes[v];
+        for (k = 0; k < node->ninputs; k++){
+            u = find(graph, node->input_names[k]);
+            if ((u < 0) || ((uint32_t)u == v)){
+                printf("[USER-ERROR] Node '%s' has unknown input '%s'\n", node->name, node->input_names[k]);
+                return 1;
+            }
+            node->inputs[k] = (uint32_t)u;
+        }
+    }
+    //Output Node - Default is the last node added
+    int output = (graph->output_name[0] == '\0') ? (int)graph->nnodes - 1 : find(graph, graph->output_name);
+    if (output < 0){
+        printf("[USER-ERROR] Graph output '%s' is not a node\n", graph->output_name);
+        return 1;
+    }
+    //Live Nodes - Those the output depends on
+    memset(live, 0, sizeof(live));
+    uint32_t stack[GRAPH_MAX_NODES * GRAPH_MAX_INPUTS], nstack = 0;
+    stack[nstack++] = (uint32_t)output;
+    while (nstack > 0){
+        v = stack[--nstack];
+        if (live[v]){
+            continue;
+        }
+        live[v] = 1;
+        for (k = 0; k < graph->nodes[v].ninputs; k++){
+            stack[nstack++] = graph->nodes[v].inputs[k];
+        }
+    }
+    for (v = 1; v < graph->nnodes; v++){
+        if (!live[v]){
+            printf("[USER-WARNING] Graph node '%s' does not reach the output and is skipped\n", graph->nodes[v].name);
+        }
+    }
+    //Topological Order - Lowest ready node first, so descriptions run in the order written where possible
+    memset(done, 0, sizeof(done));
+    done[0] = 1;
+    int progress = 1;
+    while (progress){
+        progress = 0;
+        for (v = 1; v < graph->nnodes; v++){
+            if (!live[v] || done[v]){
+                continue;
+            }
+            int ready = 1;
+            for (k = 0; k < graph->nodes[v].ninputs; k++){
+                ready &= done[graph->nodes[v].inputs[k]];
+            }
+            if (ready){
+                done[v] = 1;
+                order[norder++] = v;
+                progress = 1;
+                break;
+            }
+        }
+    }
+    for (v = 1; v < graph->nnodes; v++){
+        if (live[v] && !done[v]){
+            printf("[USER-ERROR] Graph has a cycle through node '%s'\n", graph->nodes[v].name);
+            return 1;
+        }
+    }
+    //Last Step each value is read at - The output is read after the final step
+    for (v = 0; v < GRAPH_MAX_NODES; v++){
+        last_use[v] = 0;
+    }
+    for (t = 0; t < norder; t++){
+        for (k = 0; k < graph->nodes[order[t]].ninputs; k++){
+            last_use[graph->nodes[order[t]].inputs[k]] = t;
+        }
+    }
+    last_use[output] = UINT32_MAX;
+    //Buffer Assignment - Write in place over an input whose value dies here, else reuse a freed scratch buffer
+    graph->nbuffers = 2;
+    buffers[0] = GRAPH_IN_BUFFER;
+    for (t = 0; t < norder; t++){
+        graph_node *node = &graph->nodes[order[t]];
+        graph_step *step = &graph->schedule[t];
+        uint32_t b = UINT32_MAX;
+        if (order[t] == (uint32_t)output){
+            b = GRAPH_OUT_BUFFER;
+        }
+        else{
+            for (k = 0; k < node->ninputs; k++){
+                if ((last_use[node->inputs[k]] == t) && (buffers[node->inputs[k]] >= 2)){
+                    b = buffers[node->inputs[k]];
+                    break;
+                }
+            }
+            if (b == UINT32_MAX){
+                b = (nfree > 0) ? free_list[--nfree] : graph->nbuffers++;
+            }
+        }
+        //Release inputs whose value dies here (once each, and not the one written in place)
+        for (k = 0; k < node->ninputs; k++){
+            uint32_t in = buffers[node->inputs[k]];
+            int repeat = 0;
+            for (uint32_t j = 0; j < k; j++){
+                repeat |= (node->inputs[j] == node->inputs[k]);
+            }
+            if ((last_use[node->inputs[k]] == t) && (in >= 2) && (in != b) && !repeat){
+                free_list[nfree++] = in;
+            }
+        }
+        buffers[order[t]] = b;
+        step->node = order[t];
+        step->output = b;
+        for (k = 0; k < node->ninputs; k++){
+            step->inputs[k] = buffers[node->inputs[k]];
+        }
+    }
+    graph->nsteps = norder;
+    //Input straight to Output
+    if (output == 0){
+        graph->schedule[0].node = 0;
+        graph->schedule[0].inputs[0] = GRAPH_IN_BUFFER;
+        graph->schedule[0].output = GRAPH_OUT_BUFFER;
+        graph->nsteps = 1;
+    }
+    //Scratch Buffers - Sized for the largest period, so JACK can change it live
+    free(graph->scratch);
+    graph->scratch = NULL;
+    if (graph->nbuffers > 2){
+        graph->scratch = (float*)calloc((size_t)(graph->nbuffers - 2) * INTERFACE_MAX_NFRAMES, sizeof(float));
+        if (graph->scratch == NULL){
+            fprintf(stderr, "[ERROR] in graph->scratch memory allocation\n");
+            return 1;
+        }
+    }
+    //Effects were initialised for the period - Re-derive them for the sub-block, and the filters for the first time
+    graph_update(graph, inter);
+    return 0;
+}
+
+void graph_update(graph_parameters *graph, interface_parameters *inter){
+    //Sub-Block in use - Whole periods when unset, or when it does not divide the period
+    graph->sub = *inter;
+    if ((graph->subblock != 0) && (graph->subblock < inter->nframes) && ((inter->nframes % graph->subblock) == 0)){
+        graph->sub.nframes = graph->subblock;
+    }
+    inter = &graph->sub;
+    for (uint32_t v = 1; v < graph->nnodes; v++){
+        graph_node *node = &graph->nodes[v];
+        switch (node->type){
+            case GRAPH_COMPRESSOR:
+                compressor_update((compressor_parameters*)node->effect, inter);
+                break;
+            case GRAPH_OVERDRIVE:
+                overdrive_update((overdrive_parameters*)node->effect, inter);
+                break;
+            case GRAPH_DELAY:
+                delay_update((delay_parameters*)node->effect, inter);
+                break;
+            case GRAPH_OCTAVER:
+                octaver_update((octaver_parameters*)node->effect, inter);
+                break;
+            case GRAPH_LOWPASS:
+            case GRAPH_HIGHPASS:
+                filter_coeffs(node, inter);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void graph_print(graph_parameters *graph){
+    printf("\n"
+           "/-----EFFECT GRAPH-----/\n"
+           "\n");
+    for (uint32_t t = 0; t < graph->nsteps; t++){
+        graph_step *step = &graph->schedule[t];
+        graph_node *node = &graph->nodes[step->node];
+        printf("%2u  %-12s %-10s ", t + 1, node->name, type_names[node->type]);
+        for (uint32_t k = 0; k < node->ninputs; k++){
+            printf("%s%s", (k == 0) ? "" : ",", graph->nodes[node->inputs[k]].name);
+        }
+        if (step->output == GRAPH_OUT_BUFFER){
+            printf(" -> output\n");
+        }
+        else{
+            printf(" -> buffer %u\n", step->output - 1);
+        }
+    }
+    printf("%u scratch buffer(s)\n", graph->nbuffers - 2);
+}
+
+static inline int run(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, graph_parameters *graph, interface_parameters *inter){
+    uint32_t nframes = inter->nframes;
+    uint32_t i, k;
+    //Trace - One span per step, each starting where the last ended
+    TRACE_MARK(mark);
+    for (uint32_t t = 0; t < graph->nsteps; t++){
+        graph_step *step = &graph->schedule[t];
+        graph_node *node = &graph->nodes[step->node];
+        float *x = buffer(graph, step->inputs[0], in, out);
+        float *y = buffer(graph, step->output, in, out);
+        //Bypassed Node - Its first input straight through, to the buffer it would have written
+        if (node->bypass){
+            if (y != x){
+                memcpy(y, x, nframes * sizeof(float));
+            }
+            TRACE_SPAN(node->name, mark);
+            continue;
+        }
+        switch (node->type){
+            case GRAPH_INPUT:
+                memcpy(y, x, nframes * sizeof(float));
+                break;
+            case GRAPH_COMPRESSOR:
+                //Node Fault - Logged and silenced, and the rest of the schedule still runs
+                if (compressor(x, y, (compressor_parameters*)node->effect, inter)){
+                    logger_event(LOGGER_NODE, node->name, t);
+                    memset(y, 0, nframes * sizeof(float));
+                }
+                break;
+            case GRAPH_OVERDRIVE:{
+                overdrive_parameters *drive = (overdrive_parameters*)node->effect;
+                if (overdrive(x, y, drive, inter)){
+                    logger_event(LOGGER_NODE, node->name, t);
+                }
+                advance(drive);
+                break;
+            }
+            case GRAPH_DELAY:
+                delay(x, y, (delay_parameters*)node->effect, inter);
+                break;
+            case GRAPH_OCTAVER:
+                octaver(x, y, (octaver_parameters*)node->effect, inter);
+                break;
+            case GRAPH_LOWPASS:
+            case GRAPH_HIGHPASS:
+                filter(x, y, node, nframes);
+                break;
+            case GRAPH_MIX:{
+                //Sum into a local block first - The output may be one of the inputs
+                float sum[nframes];
+                float level = node->levels[0];
+                for (i = 0; i < nframes; i++){
+                    sum[i] = level * x[i];
+                }
+                for (k = 1; k < node->ninputs; k++){
+                    float *xk = buffer(graph, step->inputs[k], in, out);
+                    level = node->levels[k];
+                    for (i = 0; i < nframes; i++){
+                        sum[i] += level * xk[i];
+                    }
+                }
+                memcpy(y, sum, nframes * sizeof(float));
+                break;
+            }
+            default:
+                logger_event(LOGGER_NODE, node->name, t);
+                return 1;
+        }
+        TRACE_SPAN(node->name, mark);
+    }
+    return 0;
+}
+
+int graph_process(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, graph_parameters *graph, interface_parameters *inter){
+    //Sub-Blocks - Effects see graph->sub, so control updates and envelope decisions happen once per sub-block
+    uint32_t len = graph->sub.nframes;
+    int err = 0;
+    for (uint32_t offset = 0; offset < inter->nframes; offset += len){
+        //Short Last Block - e.g. the end of a file rendered offline
+        if (inter->nframes - offset < len){
+            interface_parameters tail = graph->sub;
+            tail.nframes = inter->nframes - offset;
+            return err | run(&in[offset], &out[offset], graph, &tail);
+        }
+        err |= run(&in[offset], &out[offset], graph, &graph->sub);
+    }
+    return err;
+}
+
+void graph_free(graph_parameters *graph){
+    for (uint32_t v = 1; v < graph->nnodes; v++){
+        graph_node *node = &graph->nodes[v];
+        if (!node->owned){
+            continue;
+        }
+        if (node->type == GRAPH_OVERDRIVE){
+            free(((overdrive_parameters*)node->effect)->window_store);
+        }
+        else if (node->type == GRAPH_DELAY){
+            free(((delay_parameters*)node->effect)->ring);
+        }
+        free(node->effect);
+        node->effect = NULL;
+        node->owned = 0;
+    }
+    free(graph->scratch);
+    graph->scratch = NULL;
+}
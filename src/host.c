@@ -0,0 +1,516 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <jack/jack.h>
+#include <math.h>
+#include "compressor.h"
+#include "overdrive.h"
+#include "delay.h"
+#include "octaver.h"
+#include "graph.h"
+#include "interface.h"
+#include "logger.h"
+#include "pool.h"
+#include "trace.h"
+
+#define HOST_MAX_RIGS 32        //Most Rigs in one host - At most POOL_MAX_TASKS
+#define HOST_NAME 16            //Longest Rig Name (including terminator) - e.g. "rig12"
+#define HOST_LINE 256           //Longest --rig Effect List
+
+//One Rig - An independent effect graph with its own ports
+typedef struct{
+    char name[HOST_NAME];
+    char *spec;                                 //Effect list or graph description, as given to --rig
+    graph_parameters graph;
+    jack_port_t *input_port;
+    jack_port_t *output_port;
+    jack_default_audio_sample_t *in, *out;      //This period's buffers - Fetched in process(), as JACK requires
+} host_rig;
+
+jack_client_t *client;
+
+interface_parameters *inter;
+host_rig *rigs;
+uint32_t nrigs = 0;
+pool_parameters pool;
+pool_task tasks[HOST_MAX_RIGS];
+int workers = -1;
+char *trace_path = NULL;
+volatile sig_atomic_t running = 1;
+
+static inline void print_about(){
+    printf("\n"
+           "Raspberry Ripple - A Programmable Bass Guitar Effects Pedal\n"
+           "(c) Copyright 2020, Andy Silk (@silkyandrew97)\n"
+           "MIT License\n"
+           "Project Home: https://github.com/silkyandrew97/raspberry_ripple\n");
+}
+
+static inline void print_help(){
+    printf("\n"
+           "Usage:\n"
+           "  rripple_host --rig <chain> ... --rig <chain> [Additional Arguments]\n"
+           "\n"
+           "Where:\n"
+           "  chain                 Rig's Effects, as a comma separated chain (compressor, overdrive, delay or octaver)\n"
+           "                        or a graph description ending in .graph (see res/graphs)\n"
+           "                        Each rig has its own input and output port, rig<n>_in and rig<n>_out,\n"
+           "                        connected to the n-th capture and playback port where there is one\n"
+           "\n"
+           "  e.g. rripple_host --rig compressor,overdrive --rig res/graphs/split_drive.graph --rig octaver,delay\n"
+           "\n"
+           "Additional Arguments (s and d denote string and integer values respectively:\n"
+           "\n"
+           "  Interface Parameters:\n"
+           "    [--soundcard s]     Device Name\n"
+           "                        Default is hw:0\n"
+           "    [--nperiods d]      Periods per Buffer - Must be at least 1\n"
+           "                        Default is 3 - Recommended for USB Audio Interface\n"
+           "    [--nframes d]       Frames per Period - Must be in the range 1 to 4096\n"
+           "                        Default is 64 - Soundcards vary in compatibility\n"
+           "    [--fs d]            Sample Rate (Hz) - Must be in the range 44100 to 192000\n"
+           "                        Default is 48000 - Soundcards vary in compatibility\n"
+           "\n"
+           "  Host Parameters:\n"
+           "    [--rig s]           Add a Rig - Repeatable, at most 32\n"
+           "    [--workers d]       Real-Time Worker Threads besides JACK's - Must be in the range 0 to 15\n"
+           "                        Default is one per core besides JACK's\n"
+           "\n"
+           "  Trace Parameters:\n"
+           "    [--trace s]         Chrome Trace File, written on exit - Needs a build with make TRACE=1\n"
+           "                        Default is none\n"
+           "\n");
+}
+
+static inline void INThandler(int sig){
+    signal(sig, SIG_IGN);
+    //Close Client
+    printf("\n");
+    jack_client_close (client);
+    usleep(10000);
+    printf("Raspberry Ripple Host Ended\n");
+    running = 0;
+}
+
+static inline int get_args(int argc, char *argv[]){
+    int validi;
+    char err;
+    int i = 1;
+    while (i < argc){
+        if (i == (argc - 1)){
+            printf("[USER-ERROR] Not enough input arguments, please refer to usage guide below\n");
+            print_help();
+            exit(1);
+        }
+        //Interface Parameters
+        else if (strcmp(argv[i], "--soundcard") == 0){
+            inter->sclen = (uint32_t)strlen(argv[i+1]);
+            inter->soundcard = (char*)realloc(inter->soundcard, (inter->sclen + 1) * sizeof(char));
+            if (inter->soundcard == NULL){
+                fprintf(stderr, "[ERROR] in inter->soundcard memory allocation\n");
+                return 1;
+            }
+            sprintf(inter->soundcard, "%s", argv[i+1]);
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--nperiods") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 1)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            inter->plen = (uint32_t)strlen(argv[i+1]);
+            inter->nperiods = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--nframes") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 1) || (validi > INTERFACE_MAX_NFRAMES)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            inter->flen = (uint32_t)strlen(argv[i+1]);
+            inter->nframes = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--fs") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 44100) || (validi > INTERFACE_MAX_FS)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            inter->fslen = (uint32_t)strlen(argv[i+1]);
+            inter->fs = validi;
+            i+=2;
+        }
+        //Host Parameters
+        else if (strcmp(argv[i], "--rig") == 0){
+            if (nrigs == HOST_MAX_RIGS){
+                printf("[USER-ERROR] At most %u rigs, please refer to usage guide below\n", HOST_MAX_RIGS);
+                print_help();
+                exit(1);
+            }
+            rigs[nrigs].spec = argv[i+1];
+            snprintf(rigs[nrigs].name, HOST_NAME, "rig%u", nrigs + 1);
+            nrigs++;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--workers") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 0) || (validi > POOL_MAX_WORKERS)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            workers = validi;
+            i+=2;
+        }
+        //Trace Parameters
+        else if (strcmp(argv[i], "--trace") == 0){
+            trace_path = argv[i+1];
+            i+=2;
+        }
+        else{
+            printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
+            print_help();
+            exit(1);
+        }
+    }
+    if (nrigs == 0){
+        printf("[USER-ERROR] No rigs given, please refer to usage guide below\n");
+        print_help();
+        exit(1);
+    }
+    return 0;
+}
+
+//Create and Initialise one Effect of a chain with its defaults - The rig's graph frees it
+static inline void *chain_effect(const char *name, uint32_t *type){
+    void *effect = NULL;
+    if (strcmp(name, "compressor") == 0){
+        *type = GRAPH_COMPRESSOR;
+        effect = sample_alloc(sizeof(compressor_parameters));
+        if (effect != NULL){
+            compressor_default((compressor_parameters*)effect);
+            compressor_init((compressor_parameters*)effect, inter);
+        }
+    }
+    else if (strcmp(name, "overdrive") == 0){
+        *type = GRAPH_OVERDRIVE;
+        effect = sample_alloc(sizeof(overdrive_parameters));
+        if (effect != NULL){
+            overdrive_default((overdrive_parameters*)effect);
+            if (overdrive_init((overdrive_parameters*)effect, inter)){
+                free(effect);
+                return NULL;
+            }
+        }
+    }
+    else if (strcmp(name, "delay") == 0){
+        *type = GRAPH_DELAY;
+        effect = sample_alloc(sizeof(delay_parameters));
+        if (effect != NULL){
+            delay_default((delay_parameters*)effect);
+            if (delay_init((delay_parameters*)effect, inter)){
+                free(effect);
+                return NULL;
+            }
+        }
+    }
+    else if (strcmp(name, "octaver") == 0){
+        *type = GRAPH_OCTAVER;
+        effect = sample_alloc(sizeof(octaver_parameters));
+        if (effect != NULL){
+            octaver_default((octaver_parameters*)effect);
+            octaver_init((octaver_parameters*)effect, inter);
+        }
+    }
+    else{
+        printf("[USER-ERROR] Unknown effect '%s', please refer to usage guide below\n", name);
+        return NULL;
+    }
+    if (effect == NULL){
+        fprintf(stderr, "[ERROR] in %s memory allocation\n", name);
+    }
+    return effect;
+}
+
+//Rig Graph - Loaded from a graph description, or a serial chain of the effects listed
+static inline int build_rig(host_rig *rig){
+    graph_default(&rig->graph);
+    size_t len = strlen(rig->spec);
+    if ((len > 6) && (strcmp(&rig->spec[len - 6], ".graph") == 0)){
+        return graph_load(&rig->graph, rig->spec, inter) || graph_compile(&rig->graph, inter);
+    }
+    char list[HOST_LINE], *save = NULL;
+    const char *prev = "in";
+    uint32_t type;
+    snprintf(list, HOST_LINE, "%s", rig->spec);
+    //strtok_r - graph_add tokenises its own inputs
+    for (char *name = strtok_r(list, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save)){
+        void *effect = chain_effect(name, &type);
+        if (effect == NULL){
+            return 1;
+        }
+        if (graph_add(&rig->graph, name, type, prev, effect)){
+            free(effect);
+            return 1;
+        }
+        rig->graph.nodes[rig->graph.nnodes - 1].owned = 1;
+        prev = name;
+    }
+    return graph_compile(&rig->graph, inter);
+}
+
+//One Rig's Period - Run on whichever pool thread takes it
+static void rig_process(void *arg){
+    host_rig *rig = (host_rig*)arg;
+    TRACE_BEGIN(rig->name);
+    if (graph_process(rig->in, rig->out, &rig->graph, inter)){
+        logger_event(LOGGER_PROCESS, rig->name, 0);
+        memset(rig->out, 0, inter->nframes * sizeof(float));
+    }
+    TRACE_END(rig->name);
+}
+
+//Process Callback Function - Executed on each block at the correct time
+int process (jack_nframes_t nframes, void *arg){
+    TRACE_THREAD("jack process");
+    TRACE_BEGIN("process");
+    //Denormals Flushed - Set every period, as JACK may restart its thread. The workers set their own
+    sample_flush_denormals();
+    for (uint32_t r = 0; r < nrigs; r++){
+        rigs[r].in = jack_port_get_buffer (rigs[r].input_port, nframes);
+        rigs[r].out = jack_port_get_buffer (rigs[r].output_port, nframes);
+    }
+    //Every Rig across the Pool - Returns once all have written their block, so nothing is left running
+    pool_run(&pool, tasks, nrigs);
+    TRACE_END("process");
+    return 0;
+}
+
+//Re-derive every Rig for the current period and sample rate - Buffers were preallocated for the largest
+static inline void update_rigs(){
+    for (uint32_t r = 0; r < nrigs; r++){
+        graph_update(&rigs[r].graph, inter);
+    }
+}
+
+//Buffer Size Callback - JACK period changed while running
+int buffer_size (jack_nframes_t nframes, void *arg){
+    if (nframes > INTERFACE_MAX_NFRAMES){
+        fprintf(stderr, "[JACK-ERROR] Period of %u frames is more than the supported %u\n", nframes, INTERFACE_MAX_NFRAMES);
+        exit(1);
+    }
+    if (nframes != inter->nframes){
+        inter->nframes = nframes;
+        update_rigs();
+        logger_event(LOGGER_PERIOD, "jack", nframes);
+    }
+    return 0;
+}
+
+//Sample Rate Callback - JACK sample rate differs from, or changed from, the one requested
+int sample_rate (jack_nframes_t fs, void *arg){
+    if (fs > INTERFACE_MAX_FS){
+        fprintf(stderr, "[JACK-ERROR] Sample rate of %uHz is more than the supported %uHz\n", fs, INTERFACE_MAX_FS);
+        exit(1);
+    }
+    if (fs != inter->fs){
+        inter->fs = fs;
+        update_rigs();
+        logger_event(LOGGER_RATE, "jack", fs);
+    }
+    return 0;
+}
+
+//Xrun Callback - Counted, and reported by the logger thread
+int xrun (void *arg){
+    logger_event(LOGGER_XRUN, "jack", 0);
+    return 0;
+}
+
+//Shut Down Callback - if client is disconnected
+void jack_shutdown (void *arg){
+    exit (1);
+}
+
+int main (int argc, char *argv[]){
+    //Handler to catch CTRL-C
+    signal(SIGINT, INThandler);
+    //Parameter Memory Allocation
+    inter = malloc(sizeof(interface_parameters));
+    if (inter == NULL){
+        fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
+        exit(1);
+    }
+    rigs = calloc(HOST_MAX_RIGS, sizeof(host_rig));
+    if (rigs == NULL){
+        fprintf(stderr, "[ERROR] in rig memory allocation\n");
+        exit(1);
+    }
+    //Parameter Defaults
+    if(interface_default(inter)){
+        fprintf(stderr,"[ERROR] in initialising interface defaults\n");
+        exit(1);
+    }
+    pool_default(&pool);
+    //Get Parameter Arguments
+    if(get_args(argc, argv)){
+        fprintf(stderr,"[ERROR] in getting parameter arguments\n");
+        exit(1);
+    }
+    if (workers >= 0){
+        pool.nworkers = (uint32_t)workers;
+    }
+
+    //Parameter Initialisation
+    printf("\n"
+    "/-----INTERFACE CONFIGURATION-----/\n"
+    "\n");
+    interface_init(inter);
+    for (uint32_t r = 0; r < nrigs; r++){
+        if (build_rig(&rigs[r])){
+            fprintf(stderr,"[ERROR] in %s initialisation ('%s')\n", rigs[r].name, rigs[r].spec);
+            exit(1);
+        }
+        printf("\n%s: %s\n", rigs[r].name, rigs[r].spec);
+        graph_print(&rigs[r].graph);
+        tasks[r].function = rig_process;
+        tasks[r].arg = &rigs[r];
+    }
+
+    //JACK Initialisation
+    const char **ports;
+    const char *client_name = "rripple_host";
+    const char *server_name = NULL;
+    jack_options_t options = JackNullOption;
+    jack_status_t status;
+    char port_name[HOST_NAME + 4];
+    //Open a client connection to the JACK server
+    client = jack_client_open (client_name, options, &status, server_name);
+    if (client == NULL){
+        fprintf (stderr, "[JACK-ERROR] jack_client_open() failed, status = 0x%2.0x\n", status);
+        if (status & JackServerFailed){
+            fprintf (stderr, "[JACK-ERROR] Unable to connect to JACK server\n");
+        }
+        exit (1);
+    }
+    if (status & JackServerStarted){
+        fprintf (stderr, "[JACK-INFO] JACK server started\n");
+    }
+    if (status & JackNameNotUnique){
+        client_name = jack_get_client_name(client);
+        fprintf (stderr, "[JACK-INFO] Unique name `%s' assigned\n", client_name);
+    }
+    //Call process callback whenever there is work to be done
+    jack_set_process_callback (client, process, 0);
+    //Follow period and sample rate changes without restarting
+    jack_set_buffer_size_callback (client, buffer_size, 0);
+    jack_set_sample_rate_callback (client, sample_rate, 0);
+    jack_set_xrun_callback (client, xrun, 0);
+    //Call shutdown callback when disconnected
+    jack_on_shutdown (client, jack_shutdown, 0);
+    //Worker Pool - At JACK's real-time priority, so rigs on a worker are scheduled as those on JACK's thread
+    pool.priority = jack_client_real_time_priority(client);
+    if (pool.priority < 0){
+        pool.priority = 0;
+    }
+    if (pool_start(&pool)){
+        fprintf(stderr, "[ERROR] in worker pool initialisation\n");
+        exit(1);
+    }
+    //Tracer - Records from the first block
+    if (trace_path != NULL){
+        trace_enable(1);
+    }
+    //Logger Thread - Writes out what the callbacks record, off the real-time path
+    if (logger_start()){
+        fprintf(stderr, "[ERROR] in logger initialisation\n");
+        exit(1);
+    }
+    //Create two ports per rig
+    for (uint32_t r = 0; r < nrigs; r++){
+        snprintf(port_name, sizeof(port_name), "%s_in", rigs[r].name);
+        rigs[r].input_port = jack_port_register (client, port_name,
+                                 JACK_DEFAULT_AUDIO_TYPE,
+                                 JackPortIsInput, 0);
+        snprintf(port_name, sizeof(port_name), "%s_out", rigs[r].name);
+        rigs[r].output_port = jack_port_register (client, port_name,
+                                  JACK_DEFAULT_AUDIO_TYPE,
+                                  JackPortIsOutput, 0);
+        if ((rigs[r].input_port == NULL) || (rigs[r].output_port == NULL)){
+            fprintf(stderr, "[JACK-ERROR] Cannot register JACK ports\n");
+            exit (1);
+        }
+    }
+    //Run Raspberry Ripple Host
+    printf("\n"
+    "/-----RASPBERRY RIPPLE HOST-----/\n");
+    //Display Raspberry Ripple Info
+    print_about();
+    printf("\n"
+           "%u rig(s) on JACK's thread and %u worker(s)%s\n", nrigs, pool.started, (pool.priority > 0) ? ", real-time" : "");
+    if (nrigs > pool.started + 1){
+        printf("[USER-WARNING] More rigs (%u) than threads (%u) - Each period waits on the busiest thread's rigs\n", nrigs, pool.started + 1);
+    }
+    float latency = 1000.0f * (float)inter->nframes * (float)inter->nperiods / (float)inter->fs;
+    if (latency > 6.0f){
+        printf("[USER-WARNING] Latency (%.2fms) is more than 'just noticeable difference' (6ms)\n"
+               "               - Possible audible lag in real-time\n"
+               "               - Excludes converter and USB latency, measure the round trip with rripple_latency\n", latency);
+    }
+    printf("\n"
+           "Raspberry Ripple Host Started... Press CTRL-C to exit\n");
+
+    //Activate Client - Process will now start running
+    if (jack_activate (client)){
+        fprintf (stderr, "[JACK-ERROR] Cannot activate client");
+        exit (1);
+    }
+    //Connect Ports - Rig n to the n-th physical capture and playback port, the rest by hand
+    ports = jack_get_ports (client, NULL, NULL, JackPortIsPhysical|JackPortIsOutput);
+    for (uint32_t r = 0; r < nrigs; r++){
+        if ((ports == NULL) || (ports[r] == NULL)){
+            fprintf (stderr, "[JACK-WARNING] No capture port for %s_in onwards - they have to be connected manually\n", rigs[r].name);
+            break;
+        }
+        if (jack_connect (client, ports[r], jack_port_name (rigs[r].input_port))){
+            fprintf (stderr, "[JACK-WARNING] Cannot connect %s_in - it has to be done manually\n", rigs[r].name);
+        }
+    }
+    free (ports);
+    ports = jack_get_ports (client, NULL, NULL, JackPortIsPhysical|JackPortIsInput);
+    for (uint32_t r = 0; r < nrigs; r++){
+        if ((ports == NULL) || (ports[r] == NULL)){
+            fprintf (stderr, "[JACK-WARNING] No playback port for %s_out onwards - they have to be connected manually\n", rigs[r].name);
+            break;
+        }
+        if (jack_connect (client, jack_port_name (rigs[r].output_port), ports[r])){
+            fprintf (stderr, "[JACK-WARNING] Cannot connect %s_out - it has to be done manually\n", rigs[r].name);
+        }
+    }
+    free (ports);
+    //Run until stopped by user
+    while (running){
+        sleep(1);
+    }
+    //Client is closed by now, so no run is in progress
+    pool_stop(&pool);
+    if (trace_path != NULL){
+        trace_enable(0);
+        trace_dump(trace_path);
+    }
+    for (uint32_t r = 0; r < nrigs; r++){
+        graph_free(&rigs[r].graph);
+    }
+    logger_stop();
+    logger_summary(stderr);
+    exit (0);
+}
@@ -17,6 +17,7 @@ int interface_default(interface_parameters *inter){
     inter->nperiods = 3;
     inter->nframes = 64;
     inter->fs = 48000;
+    inter->dummy = 0;
     inter->sclen = 4;
     inter->plen = 1;
     inter->flen = 2;
@@ -27,7 +28,13 @@ int interface_default(interface_parameters *inter){
 void interface_init(interface_parameters *inter){
     //Input Interface Parameters
     char params[(30 + inter->sclen + inter->plen + inter->flen + inter->fslen)];
-    sprintf(params, "jackd -d alsa -d %s -n %d -p %d -r %d", inter->soundcard, inter->nperiods,  inter->nframes, inter->fs);
+    if (inter->dummy){
+        //Dummy backend keeps hardware timing without a soundcard
+        sprintf(params, "jackd -d dummy -p %d -r %d", inter->nframes, inter->fs);
+    }
+    else{
+        sprintf(params, "jackd -d alsa -d %s -n %d -p %d -r %d", inter->soundcard, inter->nperiods,  inter->nframes, inter->fs);
+    }
     char bash[(67 + strlen(params))];
     sprintf(bash, "#!/bin/bash\nkillall jackd\nsleep 1\n%s &\nsleep 1\nexit 1\n", params);
     //Run Bash Script
@@ -0,0 +1,167 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "logger.h"
+
+#define LOGGER_SLEEP 10000      //Writer Thread Poll Interval (us)
+
+static const char *event_names[LOGGER_EVENTS] = {"overdrive fault", "node fault", "process fault", "xrun", "period change", "sample rate change", "preset change"};
+
+//Bounded ring after Vyukov - Each slot's sequence says whose turn it is, so producers never wait on the writer
+//- Sequences count from the start of the slot's lap (position less slot index), so an all-zero ring starts empty
+static logger_record ring[LOGGER_RING];
+static _Atomic uint32_t write_pos = 0, read_pos = 0, dropped = 0;
+static _Atomic uint32_t counts[LOGGER_EVENTS] = {0};
+static atomic_int running = 0;
+static pthread_t thread;
+static uint64_t start_time = 0;
+
+static inline uint64_t now(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+void logger_event(uint32_t event, const char *where, uint32_t value){
+    if (event >= LOGGER_EVENTS){
+        return;
+    }
+    atomic_fetch_add_explicit(&counts[event], 1, memory_order_relaxed);
+    //Claim a Slot - Full when the writer has not yet freed the one a lap behind
+    uint32_t pos = atomic_load_explicit(&write_pos, memory_order_relaxed);
+    logger_record *record;
+    for (;;){
+        record = &ring[pos & (LOGGER_RING - 1)];
+        uint32_t lap = pos & ~(uint32_t)(LOGGER_RING - 1);
+        int32_t diff = (int32_t)(atomic_load_explicit(&record->sequence, memory_order_acquire) - lap);
+        if (diff == 0){
+            if (atomic_compare_exchange_weak_explicit(&write_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)){
+                break;
+            }
+        }
+        else if (diff < 0){
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return;
+        }
+        else{
+            pos = atomic_load_explicit(&write_pos, memory_order_relaxed);
+        }
+    }
+    record->event = event;
+    record->value = value;
+    record->time = now();
+    uint32_t i = 0;
+    if (where != NULL){
+        for (; (i < LOGGER_WHERE - 1) && (where[i] != '\0'); i++){
+            record->where[i] = where[i];
+        }
+    }
+    record->where[i] = '\0';
+    atomic_store_explicit(&record->sequence, (pos & ~(uint32_t)(LOGGER_RING - 1)) + 1, memory_order_release);
+}
+
+uint32_t logger_count(uint32_t event){
+    return (event < LOGGER_EVENTS) ? atomic_load_explicit(&counts[event], memory_order_relaxed) : 0;
+}
+
+uint32_t logger_dropped(void){
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+
+uint32_t logger_flush(FILE *stream){
+    uint32_t written = 0;
+    uint32_t pos = atomic_load_explicit(&read_pos, memory_order_relaxed);
+    for (;;){
+        logger_record *record = &ring[pos & (LOGGER_RING - 1)];
+        uint32_t lap = pos & ~(uint32_t)(LOGGER_RING - 1);
+        if (atomic_load_explicit(&record->sequence, memory_order_acquire) != lap + 1){
+            break;
+        }
+        double t = 1e-9 * (double)(int64_t)(record->time - start_time);
+        switch (record->event){
+            case LOGGER_OVERDRIVE:
+                fprintf(stream, "[RT-ERROR] Overdrive static characteristic reached no region in '%s', block silenced (at %.3fs)\n", record->where, t);
+                break;
+            case LOGGER_NODE:
+                fprintf(stream, "[RT-ERROR] Graph node '%s' failed at step %u, its output silenced (at %.3fs)\n", record->where, record->value + 1, t);
+                break;
+            case LOGGER_PROCESS:
+                fprintf(stream, "[RT-ERROR] Effect graph failed in %s, block silenced (at %.3fs)\n", record->where, t);
+                break;
+            case LOGGER_XRUN:
+                fprintf(stream, "[JACK-WARNING] Xrun (at %.3fs)\n", t);
+                break;
+            case LOGGER_PERIOD:
+                fprintf(stream, "[JACK-INFO] Period changed to %u frames\n", record->value);
+                break;
+            case LOGGER_RATE:
+                fprintf(stream, "[JACK-INFO] Sample rate changed to %uHz\n", record->value);
+                break;
+            case LOGGER_PRESET:
+                fprintf(stream, "[MIDI-INFO] Program change recalled preset %u (at %.3fs)\n", record->value, t);
+                break;
+            default:
+                break;
+        }
+        //Free the Slot for the producer one lap ahead
+        atomic_store_explicit(&record->sequence, lap + LOGGER_RING, memory_order_release);
+        pos++;
+        written++;
+    }
+    atomic_store_explicit(&read_pos, pos, memory_order_relaxed);
+    if (written > 0){
+        fflush(stream);
+    }
+    return written;
+}
+
+static void *logger_thread(void *arg){
+    //Default scheduling - Always below JACK's real-time thread
+    while (atomic_load_explicit(&running, memory_order_relaxed)){
+        logger_flush(stderr);
+        usleep(LOGGER_SLEEP);
+    }
+    return NULL;
+}
+
+int logger_start(void){
+    //Event times are printed from here
+    start_time = now();
+    atomic_store(&running, 1);
+    if (pthread_create(&thread, NULL, logger_thread, NULL)){
+        atomic_store(&running, 0);
+        fprintf(stderr, "[ERROR] in logger thread creation\n");
+        return 1;
+    }
+    return 0;
+}
+
+void logger_stop(void){
+    if (atomic_exchange(&running, 0)){
+        pthread_join(thread, NULL);
+    }
+    logger_flush(stderr);
+}
+
+void logger_summary(FILE *stream){
+    uint32_t k, total = 0;
+    for (k = 0; k < LOGGER_EVENTS; k++){
+        total += logger_count(k);
+    }
+    if (total == 0){
+        return;
+    }
+    fprintf(stream, "[LOG]");
+    for (k = 0; k < LOGGER_EVENTS; k++){
+        if (logger_count(k) > 0){
+            fprintf(stream, " %u %s(s),", logger_count(k), event_names[k]);
+        }
+    }
+    fprintf(stream, " %u not queued\n", logger_dropped());
+}
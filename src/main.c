@@ -9,18 +9,39 @@
 #include <string.h>
 #include <signal.h>
 #include <jack/jack.h>
+#include <jack/midiport.h>
 #include <math.h>
 #include "compressor.h"
 #include "overdrive.h"
+#include "delay.h"
+#include "octaver.h"
+#include "tuner.h"
+#include "graph.h"
 #include "interface.h"
+#include "logger.h"
+#include "midi.h"
+#include "trace.h"
 
 jack_port_t *input_port;
 jack_port_t *output_port;
+jack_port_t *midi_port = NULL;
 jack_client_t *client;
 
 interface_parameters *inter;
 overdrive_parameters *drive;
 compressor_parameters *comp;
+delay_parameters *dly;
+octaver_parameters *oct;
+tuner_parameters *tuner;
+graph_parameters *graph;
+midi_parameters *midi;
+char *graph_path = NULL;
+char *trace_path = NULL;
+char *cc_args[MIDI_MAX_MAPS];
+char *preset_args[MIDI_MAX_PRESETS];
+uint32_t ncc = 0, npresets = 0;
+volatile sig_atomic_t running = 1;
+uint32_t chain_len = 0;
 
 static inline void print_about(){
     printf("\n"
@@ -33,15 +54,17 @@ static inline void print_about(){
 static inline void print_help(){
     printf("\n"
            "Usage:\n"
-           "  raspberry_ripple <effect_1> <effect_2> [Additional Arguments]\n"
+           "  raspberry_ripple <effect_1> ... <effect_n> [Additional Arguments]\n"
+           "  raspberry_ripple --graph <file> [Additional Arguments]\n"
            "\n"
            "Where:\n"
-           "  effect_1              First effect in chain\n"
+           "  effect_1              First effect in chain (compressor, overdrive, delay or octaver)\n"
            "                        Default is compressor\n"
-           "  effect_2              Second effect in chain\n"
-           "                        Default is no second effect\n"
+           "  effect_2 ... effect_n Following effects in chain, each used at most once\n"
+           "                        Default is no further effects\n"
            "\n"
-           "  e.g. raspberry_ripple compressor overdrive\n"
+           "  e.g. raspberry_ripple compressor overdrive delay\n"
+           "       raspberry_ripple --graph res/graphs/split_drive.graph\n"
            "\n"
            "Additional Arguments (s, d and f denote string, integer and float values respectively:\n"
            "\n"
@@ -50,11 +73,38 @@ static inline void print_help(){
            "                        Default is hw:0\n"
            "    [--nperiods d]      Periods per Buffer - Must be at least 1\n"
            "                        Default is 3 - Recommended for USB Audio Interface\n"
-           "    [--nframes d]       Frames per Period - Must be at least 1\n"
+           "    [--nframes d]       Frames per Period - Must be in the range 1 to 4096\n"
            "                        Default is 64 - Soundcards vary in compatibility\n"
-           "    [--fs d]            Sample Rate (Hz) - Must be at least 44100\n"
+           "    [--fs d]            Sample Rate (Hz) - Must be in the range 44100 to 192000\n"
            "                        Default is 48000 - Soundcards vary in compatibility\n"
            "\n"
+           "  Graph Parameters:\n"
+           "    [--graph s]         Effect Graph Description - Replaces the effect chain (see res/graphs)\n"
+           "                        Default is none\n"
+           "    [--subblock d]      Internal Sub-Block (frames) - 0, or a power of two in the range 16 to 4096\n"
+           "                        - Effects update once per sub-block, finer than the period\n"
+           "                        Default is 0 (whole periods)\n"
+           "\n"
+           "  MIDI Parameters - A midi_in port is registered once anything is mapped:\n"
+           "    [--cc s]            Controller Mapping as <cc>:<node>.<parameter>:<min>:<max> - Repeatable\n"
+           "                        - Only parameters changed while running: compressor compression_db and gain_db,\n"
+           "                          overdrive drive and gain_db, delay time_t and tempo\n"
+           "                        e.g. --cc 11:overdrive.drive:0:1 (nodes are named after their effects)\n"
+           "    [--preset s]        Program Change Preset as <program>:<node>.<parameter>=<value>[,...] - Repeatable\n"
+           "                        e.g. --preset 0:overdrive.drive=0.2,compressor.compression_db=6\n"
+           "    [--midi_channel d]  MIDI Channel - Must be in the range 1 to 16, or 0 for any\n"
+           "                        Default is 0\n"
+           "\n"
+           "  Trace Parameters:\n"
+           "    [--trace s]         Chrome Trace File, written on exit - Needs a build with make TRACE=1\n"
+           "                        Default is none\n"
+           "\n"
+           "  Tuner Parameters:\n"
+           "    [--tuner d]         Show Tuner - 0 or 1\n"
+           "                        Default is 0\n"
+           "    [--reference f]     Reference Pitch for A4 (Hz) - Must be in the range 400 to 480\n"
+           "                        Default is 440.0f\n"
+           "\n"
            "  Compressor Parameters:\n"
            "    [--ratio f]         Compression Ratio - Must be more than 20\n"
            "                        Default is 50.0f\n"
@@ -72,6 +122,9 @@ static inline void print_help(){
            "                        Default is 6.0f\n"
            "    [--comp_gain f]     Compressor Gain (dB)\n"
            "                        Default is 0.0f\n"
+           "    [--control_rate d]  Gain Computer Interval (samples) - Must be in the range 1 to 16\n"
+           "                        - Above 1, the gain is interpolated in between for less CPU\n"
+           "                        Default is 1\n"
            "\n"
            "  Overdrive Parameters:\n"
            "    [--drive f]         Overdrive Level - Must be in the range 0 to 1 (low to high)\n"
@@ -80,6 +133,36 @@ static inline void print_help(){
            "                        Default is 0.5f\n"
            "    [--drive_gain f]    Overdrive Gain (dB)\n"
            "                        Default is 0.0f\n"
+           "\n"
+           "  Delay Parameters:\n"
+           "    [--delay_time f]    Tap Spacing (s) - Must be in the range 0 to 4\n"
+           "                        Default is 0.375f\n"
+           "    [--tempo f]         Tempo (bpm) - Syncs taps to the beat when set, overriding --delay_time\n"
+           "                        Default is 0.0f (free time)\n"
+           "    [--beats f]         Beats per Tap when synced - Must be more than 0\n"
+           "                        Default is 1.0f\n"
+           "    [--taps d]          Number of Taps - Must be in the range 1 to 4\n"
+           "                        Default is 2\n"
+           "    [--feedback f]      Feedback from Last Tap - Must be in the range 0 to 0.95\n"
+           "                        Default is 0.35f\n"
+           "    [--damping f]       Damping of Repeats - Must be in the range 0 to 1 (bright to dark)\n"
+           "                        Default is 0.3f\n"
+           "    [--mix f]           Wet Level - Must be in the range 0 to 1\n"
+           "                        Default is 0.4f\n"
+           "    [--delay_gain f]    Delay Gain (dB)\n"
+           "                        Default is 0.0f\n"
+           "\n"
+           "  Octaver Parameters:\n"
+           "    [--sub f]           Octave-Down Level - Must be in the range 0 to 1\n"
+           "                        Default is 0.8f\n"
+           "    [--dry f]           Dry Level - Must be in the range 0 to 1\n"
+           "                        Default is 0.7f\n"
+           "    [--tracking f]      Tone - Must be in the range 1 to 8 (dark to bright)\n"
+           "                        Default is 2.0f\n"
+           "    [--quality d]       Divider Quality - 0 (fs) or 1 (2x oversampled polyphase)\n"
+           "                        Default is 0\n"
+           "    [--octave_gain f]   Octaver Gain (dB)\n"
+           "                        Default is 0.0f\n"
            "\n");
 }
 
@@ -90,6 +173,7 @@ static inline void INThandler(int sig){
     jack_client_close (client);
     usleep(10000);
     printf("Raspberry Ripple Ended\n");
+    running = 0;
 }
 
 static inline int get_args(int argc, char *argv[]){
@@ -101,12 +185,7 @@ static inline int get_args(int argc, char *argv[]){
         //Find "compressor"
         if (strcmp(argv[i], "compressor") == 0){
             if (comp->chain == 0){
-                if (drive->chain == 0){
-                    comp->chain = 1;
-                }
-                else{
-                    comp->chain = 2;
-                }
+                comp->chain = ++chain_len;
             }
             else{
                 printf("[USER-ERROR] %s can only be set once in chain, please refer to usage guide below\n", argv[i]);
@@ -118,12 +197,31 @@ static inline int get_args(int argc, char *argv[]){
         //Find "overdrive"
         else if (strcmp(argv[i], "overdrive") == 0){
             if (drive->chain == 0){
-                if (comp->chain == 0){
-                    drive->chain = 1;
-                }
-                else{
-                    drive->chain = 2;
-                }
+                drive->chain = ++chain_len;
+            }
+            else{
+                printf("[USER-ERROR] %s can only be set once in chain, please refer to usage guide below\n", argv[i]);
+                print_help();
+                exit(1);
+            }
+            i++;
+        }
+        //Find "delay"
+        else if (strcmp(argv[i], "delay") == 0){
+            if (dly->chain == 0){
+                dly->chain = ++chain_len;
+            }
+            else{
+                printf("[USER-ERROR] %s can only be set once in chain, please refer to usage guide below\n", argv[i]);
+                print_help();
+                exit(1);
+            }
+            i++;
+        }
+        //Find "octaver"
+        else if (strcmp(argv[i], "octaver") == 0){
+            if (oct->chain == 0){
+                oct->chain = ++chain_len;
             }
             else{
                 printf("[USER-ERROR] %s can only be set once in chain, please refer to usage guide below\n", argv[i]);
@@ -172,7 +270,7 @@ static inline int get_args(int argc, char *argv[]){
                 print_help();
                 exit(1);
             }
-            else if(atoi(argv[i+1])<1){
+            else if((atoi(argv[i+1])<1) || (atoi(argv[i+1])>INTERFACE_MAX_NFRAMES)){
                 printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
                 print_help();
                 exit(1);
@@ -189,14 +287,101 @@ static inline int get_args(int argc, char *argv[]){
                 print_help();
                 exit(1);
             }
-            else if(atoi(argv[i+1])<44100){
+            else if((atoi(argv[i+1])<44100) || (atoi(argv[i+1])>INTERFACE_MAX_FS)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                inter->fslen = (uint32_t)strlen(argv[i+1]);
+                inter->fs = atoi(argv[i+1]);
+                i+=2;
+            }
+        }
+        //Graph Parameters
+        else if (strcmp(argv[i], "--graph") == 0){
+            graph_path = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--subblock") == 0){
+            if (sscanf(argv[i+1], "%d %c", &validi, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((validi != 0) && ((validi < INTERFACE_MIN_NFRAMES) || (validi > INTERFACE_MAX_NFRAMES) || ((validi & (validi - 1)) != 0))){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                graph->subblock = validi;
+                i+=2;
+            }
+        }
+        //MIDI Parameters - Mapped once the graph is built
+        else if (strcmp(argv[i], "--cc") == 0){
+            if (ncc == MIDI_MAX_MAPS){
+                printf("[USER-ERROR] At most %u controller mappings, please refer to usage guide below\n", MIDI_MAX_MAPS);
+                print_help();
+                exit(1);
+            }
+            cc_args[ncc++] = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--preset") == 0){
+            if (npresets == MIDI_MAX_PRESETS){
+                printf("[USER-ERROR] At most %u presets, please refer to usage guide below\n", MIDI_MAX_PRESETS);
+                print_help();
+                exit(1);
+            }
+            preset_args[npresets++] = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--midi_channel") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 0) || (validi > 16)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            midi->channel = validi;
+            i+=2;
+        }
+        //Trace Parameters
+        else if (strcmp(argv[i], "--trace") == 0){
+            trace_path = argv[i+1];
+            i+=2;
+        }
+        //Tuner Parameters
+        else if (strcmp(argv[i], "--tuner") == 0){
+            if (sscanf(argv[i+1], "%d %c", &validi, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atoi(argv[i+1])<0) || (atoi(argv[i+1])>1)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                tuner->enabled = atoi(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--reference") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<400.0f) || (atof(argv[i+1])>480.0f)){
                 printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
                 print_help();
                 exit(1);
             }
             else{
-                inter->fs = (uint32_t)strlen(argv[i+1]);
-                inter->fslen = atoi(argv[i+1]);
+                tuner->reference = atof(argv[i+1]);
                 i+=2;
             }
         }
@@ -303,6 +488,22 @@ static inline int get_args(int argc, char *argv[]){
                 i+=2;
             }
         }
+        else if (strcmp(argv[i], "--control_rate") == 0){
+            if (sscanf(argv[i+1], "%d %c", &validi, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atoi(argv[i+1])<1) || (atoi(argv[i+1])>COMPRESSOR_MAX_RATE)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                comp->control_rate = atoi(argv[i+1]);
+                i+=2;
+            }
+        }
         //Overdrive Parameters
         else if (strcmp(argv[i], "--drive") == 0){
             if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
@@ -347,15 +548,285 @@ static inline int get_args(int argc, char *argv[]){
                 i+=2;
             }
         }
+        //Delay Parameters
+        else if (strcmp(argv[i], "--delay_time") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<0.0f) || (atof(argv[i+1])>DELAY_MAX_T)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->time_t = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--tempo") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if(atof(argv[i+1])<0.0f){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->tempo = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--beats") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if(atof(argv[i+1])<=0.0f){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->beats = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--taps") == 0){
+            if (sscanf(argv[i+1], "%d %c", &validi, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atoi(argv[i+1])<1) || (atoi(argv[i+1])>DELAY_MAX_TAPS)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->taps = atoi(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--feedback") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<0.0f) || (atof(argv[i+1])>0.95f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->feedback = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--damping") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<0.0f) || (atof(argv[i+1])>1.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->damping = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--mix") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<0.0f) || (atof(argv[i+1])>1.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->mix = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--delay_gain") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                dly->gain_db = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        //Octaver Parameters
+        else if (strcmp(argv[i], "--sub") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<0.0f) || (atof(argv[i+1])>1.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                oct->sub_level = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--dry") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<0.0f) || (atof(argv[i+1])>1.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                oct->dry_level = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--tracking") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atof(argv[i+1])<1.0f) || (atof(argv[i+1])>8.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                oct->tracking = atof(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--quality") == 0){
+            if (sscanf(argv[i+1], "%d %c", &validi, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else if((atoi(argv[i+1])<0) || (atoi(argv[i+1])>1)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                oct->quality = atoi(argv[i+1]);
+                i+=2;
+            }
+        }
+        else if (strcmp(argv[i], "--octave_gain") == 0){
+            if (sscanf(argv[i+1], "%f %c", &validf, &err) != 1){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            else{
+                oct->gain_db = atof(argv[i+1]);
+                i+=2;
+            }
+        }
         else{
             printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
             print_help();
             exit(1);
         }
     }
+    //A graph replaces the chain
+    if ((graph_path != NULL) && (chain_len != 0)){
+        printf("[USER-ERROR] Give either an effect chain or --graph, please refer to usage guide below\n");
+        print_help();
+        exit(1);
+    }
     //Default Chain Order
-    if ((comp->chain == 0) && (drive->chain == 0)){
-        comp->chain = 1;
+    if ((chain_len == 0) && (graph_path == NULL)){
+        comp->chain = ++chain_len;
+    }
+    return 0;
+}
+
+//Effect Graph - Loaded from --graph, or a serial chain of the effects named on the command line
+static inline int build_graph(){
+    if (graph_path != NULL){
+        return graph_load(graph, graph_path, inter) || graph_compile(graph, inter);
+    }
+    const char *prev = "in";
+    for (uint32_t pos = 1; pos <= chain_len; pos++){
+        if (comp->chain == pos){
+            if (graph_add(graph, "compressor", GRAPH_COMPRESSOR, prev, comp)){
+                return 1;
+            }
+            prev = "compressor";
+        }
+        else if (drive->chain == pos){
+            if (graph_add(graph, "overdrive", GRAPH_OVERDRIVE, prev, drive)){
+                return 1;
+            }
+            prev = "overdrive";
+        }
+        else if (dly->chain == pos){
+            if (graph_add(graph, "delay", GRAPH_DELAY, prev, dly)){
+                return 1;
+            }
+            prev = "delay";
+        }
+        else if (oct->chain == pos){
+            if (graph_add(graph, "octaver", GRAPH_OCTAVER, prev, oct)){
+                return 1;
+            }
+            prev = "octaver";
+        }
+    }
+    return graph_compile(graph, inter);
+}
+
+//MIDI Mappings - Resolved against the built graph's nodes
+static inline int map_midi(){
+    uint32_t k, number;
+    char key[MIDI_KEY], err;
+    float min, max;
+    for (k = 0; k < ncc; k++){
+        if (sscanf(cc_args[k], "%u:%63[^:]:%f:%f %c", &number, key, &min, &max, &err) != 4){
+            printf("[USER-ERROR] Invalid value '%s' for '--cc', please refer to usage guide below\n", cc_args[k]);
+            print_help();
+            exit(1);
+        }
+        if (midi_map_cc(midi, graph, number, key, min, max)){
+            return 1;
+        }
+    }
+    for (k = 0; k < npresets; k++){
+        char *colon = strchr(preset_args[k], ':');
+        if ((colon == NULL) || (sscanf(preset_args[k], "%u:", &number) != 1)){
+            printf("[USER-ERROR] Invalid value '%s' for '--preset', please refer to usage guide below\n", preset_args[k]);
+            print_help();
+            exit(1);
+        }
+        if (midi_map_program(midi, graph, number, colon + 1)){
+            return 1;
+        }
     }
     return 0;
 }
@@ -364,43 +835,92 @@ static inline int get_args(int argc, char *argv[]){
 int process (jack_nframes_t nframes, void *arg){
     //Initialise pointers in and out to the memory area associated with each
     jack_default_audio_sample_t *in, *out;
+    TRACE_THREAD("jack process");
+    TRACE_BEGIN("process");
+    //Denormals Flushed - Set every period, as JACK may restart its thread
+    sample_flush_denormals();
     in = jack_port_get_buffer (input_port, nframes);
     out = jack_port_get_buffer (output_port, nframes);
-    //Effect Chain
-    if (comp->chain == 1){
-        if (compressor(in, out, comp, inter)){
-            fprintf(stderr,"[ERROR] in compressor effect\n");
-            exit(1);
-        }
-        if (drive->chain == 2){
-            overdrive(out, out, drive, inter);
-        }
+    //Tuner - One block copy, analysis runs on its own thread
+    if (tuner->enabled){
+        tuner_push(in, tuner, inter);
     }
-    else if (drive->chain == 1){
-        overdrive(in, out, drive, inter);
-        if (comp->chain == 2){
-            if (compressor(out, out, comp, inter)){
-                fprintf(stderr,"[ERROR] in compressor effect\n");
-                exit(1);
+    //MIDI Events - Pointers into JACK's buffer, in frame order. None are read when nothing is mapped
+    //- Only those that change a parameter are kept, so clock, notes and other channels never split the period
+    jack_midi_event_t event;
+    midi_event events[MIDI_MAX_EVENTS];
+    uint32_t nevents = 0, count = 0, e = 0;
+    void *midi_buffer = NULL;
+    if (midi_port != NULL){
+        midi_buffer = jack_port_get_buffer (midi_port, nframes);
+        count = jack_midi_get_event_count(midi_buffer);
+        for (; (e < count) && (nevents < MIDI_MAX_EVENTS); e++){
+            if ((jack_midi_event_get(&event, midi_buffer, e) == 0) && midi_relevant(midi, event.buffer, event.size)){
+                events[nevents].time = event.time;
+                events[nevents].data = event.buffer;
+                events[nevents].size = event.size;
+                nevents++;
             }
         }
     }
-    else{
-        memcpy(out, in, (sizeof(jack_default_audio_sample_t) * inter->nframes));
-        fprintf(stderr, "[ERROR] in main process\n");
+    //Effect Graph - Compiled schedule, no graph walking per block, split at any MIDI events
+    //- A fault silences the block and is written out by the logger thread, so nothing here blocks
+    if (midi_process(in, out, graph, inter, midi, events, nevents)){
+        logger_event(LOGGER_PROCESS, "process", 0);
+        memset(out, 0, nframes * sizeof(float));
+    }
+    //Events beyond MIDI_MAX_EVENTS - Applied at the end of the period
+    for (; e < count; e++){
+        if (jack_midi_event_get(&event, midi_buffer, e) == 0){
+            midi_apply(midi, event.buffer, event.size, &graph->sub);
+        }
+    }
+    TRACE_END("process");
+    return 0;
+}
+
+//Re-derive every effect for the current period and sample rate - Buffers were preallocated for the largest
+static inline void update_effects(){
+    graph_update(graph, inter);
+    if (tuner->enabled){
+        tuner_update(tuner, inter);
+    }
+}
+
+//Buffer Size Callback - JACK period changed while running
+int buffer_size (jack_nframes_t nframes, void *arg){
+    if (nframes > INTERFACE_MAX_NFRAMES){
+        fprintf(stderr, "[JACK-ERROR] Period of %u frames is more than the supported %u\n", nframes, INTERFACE_MAX_NFRAMES);
         exit(1);
     }
-    //Peak Count
-    drive->peak_count++;
-    //Buffer Count
-    drive->buffer_count++;
-    //Once window is filled, start overwriting
-    if (drive->buffer_count == drive->peak_window){
-        drive->buffer_count = 0;
+    if (nframes != inter->nframes){
+        inter->nframes = nframes;
+        update_effects();
+        logger_event(LOGGER_PERIOD, "jack", nframes);
     }
     return 0;
 }
 
+//Sample Rate Callback - JACK sample rate differs from, or changed from, the one requested
+int sample_rate (jack_nframes_t fs, void *arg){
+    if (fs > INTERFACE_MAX_FS){
+        fprintf(stderr, "[JACK-ERROR] Sample rate of %uHz is more than the supported %uHz\n", fs, INTERFACE_MAX_FS);
+        exit(1);
+    }
+    if (fs != inter->fs){
+        inter->fs = fs;
+        update_effects();
+        logger_event(LOGGER_RATE, "jack", fs);
+    }
+    return 0;
+}
+
+//Xrun Callback - Counted, and reported by the logger thread
+int xrun (void *arg){
+    logger_event(LOGGER_XRUN, "jack", 0);
+    return 0;
+}
+
 //Shut Down Callback - if client is disconnected
 void jack_shutdown (void *arg){
     exit (1);
@@ -409,22 +929,47 @@ void jack_shutdown (void *arg){
 int main (int argc, char *argv[]){
     //Handler to catch CTRL-C
     signal(SIGINT, INThandler);
-    //Parameter Memory Allocation
+    //Parameter Memory Allocation - Effects on cache line boundaries, as their hot state is aligned to one
     inter = malloc(sizeof(interface_parameters));
     if (inter == NULL){
         fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
         exit(1);
     }
-    comp = malloc(sizeof(compressor_parameters));
+    comp = sample_alloc(sizeof(compressor_parameters));
     if (comp == NULL){
         fprintf(stderr, "[ERROR] in compressor_parameters memory allocation\n");
         exit(1);
     }
-    drive = malloc(sizeof(overdrive_parameters));
+    drive = sample_alloc(sizeof(overdrive_parameters));
     if (drive == NULL){
         fprintf(stderr, "[ERROR] in overdrive_parameters memory allocation\n");
         exit(1);
     }
+    dly = sample_alloc(sizeof(delay_parameters));
+    if (dly == NULL){
+        fprintf(stderr, "[ERROR] in delay_parameters memory allocation\n");
+        exit(1);
+    }
+    oct = sample_alloc(sizeof(octaver_parameters));
+    if (oct == NULL){
+        fprintf(stderr, "[ERROR] in octaver_parameters memory allocation\n");
+        exit(1);
+    }
+    graph = malloc(sizeof(graph_parameters));
+    if (graph == NULL){
+        fprintf(stderr, "[ERROR] in graph_parameters memory allocation\n");
+        exit(1);
+    }
+    tuner = malloc(sizeof(tuner_parameters));
+    if (tuner == NULL){
+        fprintf(stderr, "[ERROR] in tuner_parameters memory allocation\n");
+        exit(1);
+    }
+    midi = malloc(sizeof(midi_parameters));
+    if (midi == NULL){
+        fprintf(stderr, "[ERROR] in midi_parameters memory allocation\n");
+        exit(1);
+    }
     //Parameter Defaults
     if(interface_default(inter)){
         fprintf(stderr,"[ERROR] in initialising interface defaults\n");
@@ -432,6 +977,11 @@ int main (int argc, char *argv[]){
     }
     compressor_default(comp);
     overdrive_default(drive);
+    delay_default(dly);
+    octaver_default(oct);
+    tuner_default(tuner);
+    graph_default(graph);
+    midi_default(midi);
     //Get Parameter Arguments
     if(get_args(argc, argv)){
         fprintf(stderr,"[ERROR] in getting parameter arguments\n");
@@ -448,6 +998,24 @@ int main (int argc, char *argv[]){
         fprintf(stderr,"[ERROR] in overdrive parameter initialisation\n");
         exit(1);
     }
+    if(delay_init(dly, inter)){
+        fprintf(stderr,"[ERROR] in delay parameter initialisation\n");
+        exit(1);
+    }
+    octaver_init(oct, inter);
+    if(build_graph()){
+        fprintf(stderr,"[ERROR] in effect graph initialisation\n");
+        exit(1);
+    }
+    graph_print(graph);
+    if(map_midi()){
+        fprintf(stderr,"[ERROR] in MIDI mapping\n");
+        exit(1);
+    }
+    if(tuner->enabled && (tuner_init(tuner, inter) || tuner_start(tuner))){
+        fprintf(stderr,"[ERROR] in tuner initialisation\n");
+        exit(1);
+    }
     
     //JACK Initialisation
     const char **ports;
@@ -473,8 +1041,21 @@ int main (int argc, char *argv[]){
     }
     //Call process callback whenever there is work to be done
     jack_set_process_callback (client, process, 0);
+    //Follow period and sample rate changes without restarting
+    jack_set_buffer_size_callback (client, buffer_size, 0);
+    jack_set_sample_rate_callback (client, sample_rate, 0);
+    jack_set_xrun_callback (client, xrun, 0);
     //Call shutdown callback when disconnected
     jack_on_shutdown (client, jack_shutdown, 0);
+    //Tracer - Records from the first block
+    if (trace_path != NULL){
+        trace_enable(1);
+    }
+    //Logger Thread - Writes out what the callbacks record, off the real-time path
+    if (logger_start()){
+        fprintf(stderr, "[ERROR] in logger initialisation\n");
+        exit(1);
+    }
     //Create two ports
     input_port = jack_port_register (client, "input",
                      JACK_DEFAULT_AUDIO_TYPE,
@@ -486,6 +1067,15 @@ int main (int argc, char *argv[]){
         fprintf(stderr, "[JACK-ERROR] Cannot register JACK ports\n");
         exit (1);
     }
+    if ((midi->nmaps + midi->npresets) > 0){
+        midi_port = jack_port_register (client, "midi_in",
+                        JACK_DEFAULT_MIDI_TYPE,
+                        JackPortIsInput, 0);
+        if (midi_port == NULL){
+            fprintf(stderr, "[JACK-ERROR] Cannot register JACK MIDI port\n");
+            exit (1);
+        }
+    }
     //Run Raspberry Ripple
     printf("\n"
     "/-----RASPBERRY RIPPLE-----/\n");
@@ -505,7 +1095,8 @@ int main (int argc, char *argv[]){
     float latency = 1000.0f * (float)inter->nframes * (float)inter->nperiods / (float)inter->fs;
     if (latency > 6.0f){
         printf("[USER-WARNING] Latency (%.2fms) is more than 'just noticeable difference' (6ms)\n"
-               "               - Possible audible lag in real-time\n", latency);
+               "               - Possible audible lag in real-time\n"
+               "               - Excludes converter and USB latency, measure the round trip with rripple_latency\n", latency);
     }
     printf("\n"
            "Raspberry Ripple Started... Press CTRL-C to exit\n");
@@ -534,7 +1125,42 @@ int main (int argc, char *argv[]){
         fprintf (stderr, "[JACK-WARNING] Cannot connect output port - it has to be done manually\n");
     }
     free (ports);
-    //Run until stopped by user
-    sleep (-1);
+    //MIDI - First physical MIDI capture port, e.g. a USB MIDI footswitch (ALSA MIDI needs a2jmidid or jackd -X)
+    if (midi_port != NULL){
+        ports = jack_get_ports (client, NULL, JACK_DEFAULT_MIDI_TYPE, JackPortIsPhysical|JackPortIsOutput);
+        if ((ports == NULL) || jack_connect (client, ports[0], jack_port_name (midi_port))){
+            fprintf (stderr, "[JACK-WARNING] Cannot connect MIDI port - it has to be done manually\n");
+        }
+        free (ports);
+    }
+    //Run until stopped by user - Tuner readout refreshed every 100ms
+    float freq, cents;
+    char name[5];
+    while (running){
+        if (tuner->enabled){
+            if (tuner_read(tuner, &freq, &cents, name)){
+                printf("\r[TUNER] %-4s %+6.1f cents (%6.1fHz)  ", name, cents, freq);
+            }
+            else{
+                printf("\r[TUNER] --                            ");
+            }
+            fflush(stdout);
+            usleep(100000);
+        }
+        else{
+            sleep(1);
+        }
+    }
+    if (tuner->enabled){
+        tuner_free(tuner);
+    }
+    //Client is closed by now, so no thread is still recording
+    if (trace_path != NULL){
+        trace_enable(0);
+        trace_dump(trace_path);
+    }
+    graph_free(graph);
+    logger_stop();
+    logger_summary(stderr);
     exit (0);
 }
@@ -0,0 +1,250 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <string.h>
+#include "midi.h"
+#include "logger.h"
+#include "trace.h"
+
+//Status Bytes - High nibble, the low nibble is the channel
+#define MIDI_CONTROL_CHANGE 0xB0
+#define MIDI_PROGRAM_CHANGE 0xC0
+
+//Live Parameters by node type and name - Each has a setter that ramps from wherever it had reached
+static const struct{
+    const char *key;
+    uint32_t type;
+    uint32_t parameter;
+} live[] = {
+    {"compression_db", GRAPH_COMPRESSOR, MIDI_COMPRESSION_DB},
+    {"gain_db", GRAPH_COMPRESSOR, MIDI_COMPRESSOR_GAIN},
+    {"drive", GRAPH_OVERDRIVE, MIDI_DRIVE},
+    {"gain_db", GRAPH_OVERDRIVE, MIDI_DRIVE_GAIN},
+    {"time_t", GRAPH_DELAY, MIDI_DELAY_TIME},
+    {"tempo", GRAPH_DELAY, MIDI_TEMPO},
+};
+
+//Resolve "<node>.<parameter>" to a live parameter, checking each value against the parameter's range
+static inline int resolve(graph_parameters *graph, const char *key, const float *values, uint32_t nvalues, midi_target *target){
+    union{
+        compressor_parameters comp;
+        overdrive_parameters drive;
+        delay_parameters dly;
+        octaver_parameters oct;
+    } check;
+    const char *dot = strchr(key, '.');
+    if ((dot == NULL) || (strlen(key) >= MIDI_KEY)){
+        printf("[USER-ERROR] Expected '<node>.<parameter>' for '%s'\n", key);
+        return 1;
+    }
+    size_t len = (size_t)(dot - key);
+    for (uint32_t v = 1; v < graph->nnodes; v++){
+        graph_node *node = &graph->nodes[v];
+        if ((strlen(node->name) != len) || (strncmp(node->name, key, len) != 0)){
+            continue;
+        }
+        for (uint32_t k = 0; k < sizeof(live) / sizeof(live[0]); k++){
+            if ((live[k].type != node->type) || (strcmp(live[k].key, dot + 1) != 0)){
+                continue;
+            }
+            for (uint32_t i = 0; i < nvalues; i++){
+                if (graph_parameter(node->type, &check, dot + 1, values[i])){
+                    printf("[USER-ERROR] Value %g out of range for '%s'\n", values[i], key);
+                    return 1;
+                }
+            }
+            target->parameter = live[k].parameter;
+            target->effect = node->effect;
+            snprintf(target->key, MIDI_KEY, "%s", key);
+            return 0;
+        }
+        printf("[USER-ERROR] '%s' is not a parameter changed while running (compressor compression_db and gain_db,\n"
+               "             overdrive drive and gain_db, delay time_t and tempo)\n", key);
+        return 1;
+    }
+    printf("[USER-ERROR] No node in graph for '%s'\n", key);
+    return 1;
+}
+
+//Set a Live Parameter - Others of the same effect keep their values
+static inline void set(midi_target *target, float value, interface_parameters *inter){
+    compressor_parameters *comp = (compressor_parameters*)target->effect;
+    overdrive_parameters *drive = (overdrive_parameters*)target->effect;
+    delay_parameters *dly = (delay_parameters*)target->effect;
+    switch (target->parameter){
+        case MIDI_COMPRESSION_DB:
+            compressor_set(comp, value, comp->gain_db);
+            break;
+        case MIDI_COMPRESSOR_GAIN:
+            compressor_set(comp, comp->compression_db, value);
+            break;
+        case MIDI_DRIVE:
+            overdrive_set(drive, value, drive->gain_db);
+            break;
+        case MIDI_DRIVE_GAIN:
+            overdrive_set(drive, drive->drive, value);
+            break;
+        case MIDI_DELAY_TIME:
+            delay_set_time(dly, value, dly->tempo, inter);
+            break;
+        case MIDI_TEMPO:
+            delay_set_time(dly, dly->time_t, value, inter);
+            break;
+        default:
+            break;
+    }
+}
+
+void midi_default(midi_parameters *midi){
+    midi->channel = 0;
+    midi->nmaps = 0;
+    midi->npresets = 0;
+}
+
+int midi_map_cc(midi_parameters *midi, graph_parameters *graph, uint32_t cc, const char *key, float min, float max){
+    const float range[2] = {min, max};
+    if (cc > 127){
+        printf("[USER-ERROR] Controller %u is not in the range 0 to 127\n", cc);
+        return 1;
+    }
+    if (midi->nmaps == MIDI_MAX_MAPS){
+        printf("[USER-ERROR] At most %u controller mappings\n", MIDI_MAX_MAPS);
+        return 1;
+    }
+    midi_map *map = &midi->maps[midi->nmaps];
+    if (resolve(graph, key, range, 2, &map->target)){
+        return 1;
+    }
+    map->cc = cc;
+    map->min = min;
+    map->max = max;
+    midi->nmaps++;
+    return 0;
+}
+
+int midi_map_program(midi_parameters *midi, graph_parameters *graph, uint32_t program, const char *settings){
+    char list[MIDI_MAX_SETTINGS * MIDI_KEY], *save = NULL;
+    float value;
+    char err;
+    if (program > 127){
+        printf("[USER-ERROR] Program %u is not in the range 0 to 127\n", program);
+        return 1;
+    }
+    if (midi->npresets == MIDI_MAX_PRESETS){
+        printf("[USER-ERROR] At most %u presets\n", MIDI_MAX_PRESETS);
+        return 1;
+    }
+    midi_preset *preset = &midi->presets[midi->npresets];
+    preset->program = program;
+    preset->nsettings = 0;
+    snprintf(list, sizeof(list), "%s", settings);
+    for (char *setting = strtok_r(list, ",", &save); setting != NULL; setting = strtok_r(NULL, ",", &save)){
+        char *eq = strchr(setting, '=');
+        if ((eq == NULL) || (sscanf(eq + 1, "%f %c", &value, &err) != 1)){
+            printf("[USER-ERROR] Expected '<node>.<parameter>=<value>' for '%s'\n", setting);
+            return 1;
+        }
+        if (preset->nsettings == MIDI_MAX_SETTINGS){
+            printf("[USER-ERROR] A preset sets at most %u parameters\n", MIDI_MAX_SETTINGS);
+            return 1;
+        }
+        *eq = '\0';
+        if (resolve(graph, setting, &value, 1, &preset->targets[preset->nsettings])){
+            return 1;
+        }
+        preset->values[preset->nsettings++] = value;
+    }
+    if (preset->nsettings == 0){
+        printf("[USER-ERROR] Preset for program %u sets nothing\n", program);
+        return 1;
+    }
+    midi->npresets++;
+    return 0;
+}
+
+int midi_relevant(midi_parameters *midi, const uint8_t *data, size_t size){
+    uint32_t k;
+    if ((size < 2) || ((midi->channel != 0) && ((uint32_t)(data[0] & 0x0F) + 1 != midi->channel))){
+        return 0;
+    }
+    if (((data[0] & 0xF0) == MIDI_CONTROL_CHANGE) && (size >= 3)){
+        for (k = 0; k < midi->nmaps; k++){
+            if (midi->maps[k].cc == (uint32_t)(data[1] & 0x7F)){
+                return 1;
+            }
+        }
+    }
+    else if ((data[0] & 0xF0) == MIDI_PROGRAM_CHANGE){
+        for (k = 0; k < midi->npresets; k++){
+            if (midi->presets[k].program == (uint32_t)(data[1] & 0x7F)){
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int midi_apply(midi_parameters *midi, const uint8_t *data, size_t size, interface_parameters *inter){
+    uint32_t k, s, changed = 0;
+    if (!midi_relevant(midi, data, size)){
+        return 0;
+    }
+    //Control Change - Controller value 0 to 127 across each mapping's range
+    if (((data[0] & 0xF0) == MIDI_CONTROL_CHANGE) && (size >= 3)){
+        float position = (float)(data[2] & 0x7F) / 127.0f;
+        for (k = 0; k < midi->nmaps; k++){
+            midi_map *map = &midi->maps[k];
+            if (map->cc == (uint32_t)(data[1] & 0x7F)){
+                set(&map->target, map->min + position * (map->max - map->min), inter);
+                changed = 1;
+            }
+        }
+    }
+    //Program Change - Every setting of the matching preset
+    else if ((data[0] & 0xF0) == MIDI_PROGRAM_CHANGE){
+        for (k = 0; k < midi->npresets; k++){
+            midi_preset *preset = &midi->presets[k];
+            if (preset->program != (uint32_t)(data[1] & 0x7F)){
+                continue;
+            }
+            for (s = 0; s < preset->nsettings; s++){
+                set(&preset->targets[s], preset->values[s], inter);
+            }
+            logger_event(LOGGER_PRESET, "midi", preset->program);
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+int midi_process(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, graph_parameters *graph, interface_parameters *inter, midi_parameters *midi, midi_event *events, uint32_t nevents){
+    //No Events that change anything - The whole period in one go
+    uint32_t done = 0, e;
+    for (e = 0; (e < nevents) && !midi_relevant(midi, events[e].data, events[e].size); e++);
+    if (e == nevents){
+        return graph_process(in, out, graph, inter);
+    }
+    interface_parameters part = *inter;
+    int err = 0;
+    TRACE_BEGIN("midi");
+    for (; e < nevents; e++){
+        if (!midi_relevant(midi, events[e].data, events[e].size)){
+            continue;
+        }
+        uint32_t time = (events[e].time < inter->nframes) ? events[e].time : inter->nframes;
+        //Frames before the Event - Events at the same frame share one split
+        if (time > done){
+            part.nframes = time - done;
+            err |= graph_process(&in[done], &out[done], graph, &part);
+            done = time;
+        }
+        midi_apply(midi, events[e].data, events[e].size, &graph->sub);
+    }
+    if (done < inter->nframes){
+        part.nframes = inter->nframes - done;
+        err |= graph_process(&in[done], &out[done], graph, &part);
+    }
+    TRACE_END("midi");
+    return err;
+}
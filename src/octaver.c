@@ -0,0 +1,148 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include "octaver.h"
+
+#define PI 3.14159265f
+#define PRE_CUTOFF 300.0f       //Fundamental isolation low-pass (Hz) - Above a bass's 24th fret G
+#define HYSTERESIS 0.1f         //Schmitt trigger threshold as a fraction of the envelope
+#define GATE 0.0001f            //Smallest trigger threshold - Stops noise toggling the divider
+//7-tap half-band filter (-1, 0, 9, 16, 9, 0, -1)/32
+#define HB_A -0.03125f
+#define HB_B 0.28125f
+#define HB_C 0.5f
+
+static inline float db2lin(float db){
+    return powf(10.0f, 0.05f * db);
+}
+
+static inline float divider(octaver_parameters *oct, float x, float env){
+    //Schmitt Trigger Zero-Crossing Detection - Branch-free, constant cost
+    float th = HYSTERESIS * env + GATE;
+    float sign = (x > th) ? 1.0f : ((x < -th) ? -1.0f : oct->sign);
+    float rising = (sign > oct->sign) ? 1.0f : 0.0f;
+    oct->sign = sign;
+    //Flip-Flop - Toggles on every rising crossing, halving the frequency
+    oct->flip = (rising > 0.0f) ? -oct->flip : oct->flip;
+    //Period Tracking (frames between rising crossings)
+    oct->count += 1.0f;
+    oct->period = (rising > 0.0f) ? oct->count : oct->period;
+    oct->count = (rising > 0.0f) ? 0.0f : oct->count;
+    //Tracking Low-Pass - Cutoff follows the octave-down frequency fs / (2 * period)
+    float w = PI * oct->tracking / oct->period;
+    float a = w / (1.0f + w);
+    oct->post_lp[0] += a * (oct->flip * env - oct->post_lp[0]);
+    oct->post_lp[1] += a * (oct->post_lp[0] - oct->post_lp[1]);
+    return oct->post_lp[1];
+}
+
+void octaver_default(octaver_parameters *oct){
+    //Set Default Parameters
+    oct->sub_level = 0.8f;
+    oct->dry_level = 0.7f;
+    oct->tracking = 2.0f;
+    oct->quality = 0;
+    oct->gain_db = 0.0f;
+    oct->chain = 0;
+}
+
+void octaver_init(octaver_parameters *oct, interface_parameters *inter){
+    //Parameter Initialisation
+    octaver_update(oct, inter);
+    //State
+    uint32_t i;
+    oct->pre_lp[0] = oct->pre_lp[1] = 0.0f;
+    oct->post_lp[0] = oct->post_lp[1] = 0.0f;
+    oct->env = 0.0f;
+    oct->sign = -1.0f;
+    oct->flip = 1.0f;
+    oct->count = 0.0f;
+    oct->period = (float)inter->fs;
+    for (i = 0; i < 4; i++){
+        oct->up_hist[i] = 0.0f;
+    }
+    for (i = 0; i < 7; i++){
+        oct->down_hist[i] = 0.0f;
+    }
+}
+
+void octaver_update(octaver_parameters *oct, interface_parameters *inter){
+    oct->gain = db2lin(oct->gain_db);
+    oct->pre_coeff = 1.0f - expf(-2.0f * PI * PRE_CUTOFF / (float)inter->fs);
+    oct->env_att = 1.0f - expf(-1.0f / (0.005f * (float)inter->fs));
+    oct->env_rel = 1.0f - expf(-1.0f / (0.05f * (float)inter->fs));
+}
+
+size_t octaver_state_size(octaver_parameters *oct){
+    return sizeof(octaver_state);
+}
+
+void octaver_snapshot(octaver_parameters *oct, void *buffer){
+    octaver_state *state = (octaver_state*)buffer;
+    memcpy(state->pre_lp, oct->pre_lp, sizeof(state->pre_lp));
+    state->env = oct->env;
+    state->sign = oct->sign;
+    state->flip = oct->flip;
+    state->count = oct->count;
+    state->period = oct->period;
+    memcpy(state->post_lp, oct->post_lp, sizeof(state->post_lp));
+    memcpy(state->up_hist, oct->up_hist, sizeof(state->up_hist));
+    memcpy(state->down_hist, oct->down_hist, sizeof(state->down_hist));
+}
+
+int octaver_restore(octaver_parameters *oct, const void *buffer){
+    const octaver_state *state = (const octaver_state*)buffer;
+    memcpy(oct->pre_lp, state->pre_lp, sizeof(oct->pre_lp));
+    oct->env = state->env;
+    oct->sign = state->sign;
+    oct->flip = state->flip;
+    oct->count = state->count;
+    oct->period = state->period;
+    memcpy(oct->post_lp, state->post_lp, sizeof(oct->post_lp));
+    memcpy(oct->up_hist, state->up_hist, sizeof(oct->up_hist));
+    memcpy(oct->down_hist, state->down_hist, sizeof(oct->down_hist));
+    return 0;
+}
+
+int octaver(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, octaver_parameters *oct, interface_parameters *inter){
+    float dry, x, abs, sub;
+    uint32_t i;
+    for (i = 0; i < inter->nframes; i++){
+        //Anomaly Detection - NaN or Inf would stay in the filters for good, so they give 0
+        dry = (fabsf(in[i]) <= FLT_MAX) ? in[i] : 0.0f;
+        //Isolate Fundamental
+        oct->pre_lp[0] += oct->pre_coeff * (dry - oct->pre_lp[0]);
+        oct->pre_lp[1] += oct->pre_coeff * (oct->pre_lp[0] - oct->pre_lp[1]);
+        x = oct->pre_lp[1];
+        //Envelope Follower
+        abs = fabsf(x);
+        oct->env += ((abs > oct->env) ? oct->env_att : oct->env_rel) * (abs - oct->env);
+        if (oct->quality){
+            //Polyphase 2x Interpolation - Even phase is the half-sample point, odd phase a pure delay
+            oct->up_hist[3] = oct->up_hist[2];
+            oct->up_hist[2] = oct->up_hist[1];
+            oct->up_hist[1] = oct->up_hist[0];
+            oct->up_hist[0] = x;
+            float up0 = 2.0f * (HB_A * (oct->up_hist[0] + oct->up_hist[3]) + HB_B * (oct->up_hist[1] + oct->up_hist[2]));
+            float up1 = oct->up_hist[1];
+            //Divider at 2x, then Polyphase Decimation
+            for (uint32_t j = 6; j > 1; j--){
+                oct->down_hist[j] = oct->down_hist[j-2];
+            }
+            oct->down_hist[1] = divider(oct, up0, oct->env);
+            oct->down_hist[0] = divider(oct, up1, oct->env);
+            sub = HB_A * (oct->down_hist[0] + oct->down_hist[6]) + HB_B * (oct->down_hist[2] + oct->down_hist[4]) + HB_C * oct->down_hist[3];
+        }
+        else{
+            sub = divider(oct, x, oct->env);
+        }
+        //Mix and Gain
+        out[i] = (oct->dry_level * dry + oct->sub_level * sub) * oct->gain;
+    }
+    return 0;
+}
@@ -4,25 +4,21 @@
 
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <float.h>
 #include "overdrive.h"
+#include "peak.h"
+#include "logger.h"
+#include "trace.h"
 
-#define THRESHOLD 0.3333333f
+#define THRESHOLD OVERDRIVE_THRESHOLD
 
 static inline float db2lin(float db){
     return powf(10.0f, 0.05f * db);
 }
 
-static inline void peak_calcs(jack_default_audio_sample_t *in, overdrive_parameters *drive, interface_parameters *inter, float prev_peak, float *local_store){
-    //Calculate peak from current period
-    float local_peak = 0.0f;
-    float abs;
+static inline void peak_calcs(jack_default_audio_sample_t *in, float local_peak, overdrive_parameters *drive, interface_parameters *inter, float prev_peak, float *local_store){
     uint32_t i;
-    for (i = 0; i < inter->nframes; i++){
-        abs = fabsf(in[i]);
-        if (abs > local_peak){
-            local_peak = abs;
-        }
-    }
     //Assign period peak to window_store
     drive->window_store[drive->buffer_count] = local_peak;
     //If current period peak is larger than what is stored in the window
@@ -31,26 +27,12 @@ static inline void peak_calcs(jack_default_audio_sample_t *in, overdrive_paramet
         drive->peak = local_peak;
         //Reset peak counter
         drive->peak_count = 0;
-        //Peak Smoothing
-        float prev_sample;
-        for (i = 0; i < inter->nframes; i++){
-            abs = fabsf(in[i]);
-            if (i != 0){
-                prev_sample = local_store[i-1];
-            }
-            else{
-                prev_sample = prev_peak;
-            }
-            if (abs > prev_sample){
-                local_store[i] = abs;
-            }
-            else{
-                local_store[i] = prev_sample;
-            }
-        }
+        //Peak Smoothing - Running peak from the previous window peak
+        peak_prefix_max(in, inter->nframes, prev_peak, local_store);
     }
     //If largest peak lost from window
     else if (drive->peak_count == drive->peak_window){
+        TRACE_BEGIN("peak rescan");
         //Calucate new window peak
         drive->peak = local_peak;
         uint32_t high = drive->buffer_count;
@@ -78,19 +60,22 @@ static inline void peak_calcs(jack_default_audio_sample_t *in, overdrive_paramet
                 local_store[i] = prev_peak - (((float)i+1.0f) * linspace);
             }
         }
+        TRACE_END("peak rescan");
     }
 }
 
-static inline int effect(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, overdrive_parameters *drive, interface_parameters *inter, float prev_peak, float *local_store){
+static inline int effect(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, overdrive_parameters *drive, interface_parameters *inter, float prev_peak, float *local_store,
+                         const float *drive_coeff, const float *norm_factor, const float *gain, const uint32_t stride){
+    //drive_coeff, norm_factor and gain are per-sample ramps (stride 1) or the settled values (stride 0)
     float norm, abs;
     uint32_t i;
     for (i = 0; i<inter->nframes; i++){
         //Apply Drive Coefficient
         if (drive->peak == prev_peak){
-            local_store[i] = drive->peak * drive->drive_coeff;
+            local_store[i] = drive->peak * drive_coeff[i * stride];
         }
         else{
-            local_store[i] *= drive->drive_coeff;
+            local_store[i] *= drive_coeff[i * stride];
         }
         //Normalise
         norm = in[i] / local_store[i];
@@ -122,19 +107,29 @@ static inline int effect(jack_default_audio_sample_t *in, jack_default_audio_sam
                 }
             }
             else{
-                out[i] = in[i];
-                fprintf(stderr, "[ERROR] in Overdrive Static Characteristic\n");
                 return 1;
             }
             //Drive Coefficent Normalisation
-            out[i] /= drive->norm_factor;
+            out[i] /= norm_factor[i * stride];
             //Apply Gain
-            out[i] *= drive->gain;
+            out[i] *= gain[i * stride];
         }
     }
     return 0;
 }
 
+static inline void drive_coeffs(float drive_level, float *drive_coeff, float *norm_factor){
+    //Drive Coefficient and its Normalisation Factor
+    *drive_coeff = 1.0f + (2.0f * powf((1.0f - drive_level), 2.5f));
+    float inv_drive_coeff = 1.0f / *drive_coeff;
+    if (inv_drive_coeff < (2 * THRESHOLD)){
+        *norm_factor = *drive_coeff * (3.0f - powf((2.0f - inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
+    }
+    else{
+        *norm_factor = *drive_coeff;
+    }
+}
+
 void overdrive_default(overdrive_parameters *drive){
     //Set Default Parameters
     drive->drive = 0.5f;
@@ -149,14 +144,30 @@ void overdrive_default(overdrive_parameters *drive){
 int overdrive_init(overdrive_parameters *drive, interface_parameters *inter){
     //Parameter Initialisation
     drive->gain = db2lin(drive->gain_db);
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
+    drive_coeffs(drive->drive, &drive->drive_coeff, &drive->norm_factor);
     drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < (2 * THRESHOLD)){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
+    //Runtime Changes - Settled at the initial values
+    ramp_init(&drive->drive_ramp, drive->drive_coeff, RAMP_LINEAR, inter);
+    ramp_init(&drive->norm_ramp, drive->norm_factor, RAMP_EXPONENTIAL, inter);
+    ramp_init(&drive->gain_ramp, drive->gain, RAMP_EXPONENTIAL, inter);
+    //Allocate memory needed to store each block's peak value
+    //- Enough blocks for the highest sample rate at the smallest period, so JACK can change either live
+    uint32_t nframes = (inter->nframes < INTERFACE_MIN_NFRAMES) ? inter->nframes : INTERFACE_MIN_NFRAMES;
+    uint32_t fs = (inter->fs > INTERFACE_MAX_FS) ? inter->fs : INTERFACE_MAX_FS;
+    drive->window_max = (uint32_t)(floorf(drive->window_t * (float)fs)) / nframes + 1;
+    drive->window_store = (float*)sample_alloc((size_t)drive->window_max * sizeof(float));
+    if (drive->window_store == NULL){
+        fprintf(stderr, "[ERROR] in drive->window_store memory allocation\n");
+        return 1;
     }
+    overdrive_update(drive, inter);
+    return 0;
+}
+
+void overdrive_update(overdrive_parameters *drive, interface_parameters *inter){
+    ramp_update(&drive->drive_ramp, inter);
+    ramp_update(&drive->norm_ramp, inter);
+    ramp_update(&drive->gain_ramp, inter);
     //Sliding Window Calculations
     //Calculate sliding window size rounded up to nearest block multiple
     uint32_t window_n = (uint32_t)(floorf(drive->window_t * (float)inter->fs));
@@ -168,19 +179,21 @@ int overdrive_init(overdrive_parameters *drive, interface_parameters *inter){
     else{
         window = window_n;
     }
-    //Allocate memory needed to store each block's peak value
     drive->peak_window = window/inter->nframes;
-    drive->window_store = (float*)malloc((float)drive->peak_window * sizeof(float));
-    if (drive->window_store == NULL){
-        fprintf(stderr, "[ERROR] in drive->window_store memory allocation\n");
-        return 1;
+    //At least one block - A window shorter than one sample would otherwise leave none to hold the peak
+    if (drive->peak_window == 0){
+        drive->peak_window = 1;
+    }
+    if (drive->peak_window > drive->window_max){
+        drive->peak_window = drive->window_max;
     }
-    //Initialise
+    //Restart the window holding the current peak
     uint32_t i;
     for (i = 0; i < drive->peak_window; i++) {
-        drive->window_store[i] = 0.0f;
+        drive->window_store[i] = drive->peak;
     }
-    return 0;
+    drive->buffer_count = 0;
+    drive->peak_count = 0;
 }
 
 int overdrive(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, overdrive_parameters *drive, interface_parameters *inter){
@@ -188,11 +201,174 @@ int overdrive(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out,
     float local_store[inter->nframes];
     float *ls = local_store;
     //Peak Calculations
-    peak_calcs(in, drive, inter, prev_peak, ls);
-    //Effect and Gain
-    if (effect(in, out, drive, inter, prev_peak, ls)){
-        fprintf(stderr,"[ERROR] in overdrive effect\n");
-        exit(1);
+    peak_calcs(in, peak_max_abs(in, inter->nframes), drive, inter, prev_peak, ls);
+    //Effect and Gain - Settled parameters skip ramp work entirely
+    int err;
+    const int settled = ramp_settled(&drive->drive_ramp) && ramp_settled(&drive->norm_ramp) && ramp_settled(&drive->gain_ramp);
+    const float env = drive->peak * drive->drive_coeff;
+    if (settled && (drive->peak == prev_peak) && (env >= FLT_MIN)){
+        //Constant Envelope - Most blocks, normalised by one reciprocal
+        overdrive_curve_block(in, out, env, drive->gain / drive->norm_factor, inter->nframes);
+        err = 0;
+    }
+    else if (settled){
+        err = effect(in, out, drive, inter, prev_peak, ls, &drive->drive_coeff, &drive->norm_factor, &drive->gain, 0);
+    }
+    else{
+        float drive_coeff[inter->nframes];
+        float norm_factor[inter->nframes];
+        float gain[inter->nframes];
+        ramp_block(&drive->drive_ramp, drive_coeff, inter->nframes);
+        ramp_block(&drive->norm_ramp, norm_factor, inter->nframes);
+        ramp_block(&drive->gain_ramp, gain, inter->nframes);
+        drive->drive_coeff = drive->drive_ramp.current;
+        drive->norm_factor = drive->norm_ramp.current;
+        drive->gain = drive->gain_ramp.current;
+        err = effect(in, out, drive, inter, prev_peak, ls, drive_coeff, norm_factor, gain, 1);
+    }
+    //Fault - Reported by the logger thread, never from here
+    if (err){
+        logger_event(LOGGER_OVERDRIVE, "overdrive", 0);
+        memset(out, 0, inter->nframes * sizeof(float));
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t overdrive_envelope(jack_default_audio_sample_t *in, float local_peak, float *env, overdrive_parameters *drive, interface_parameters *inter){
+    float prev_peak = drive->peak;
+    peak_calcs(in, local_peak, drive, inter, prev_peak, env);
+    //Constant Envelope - Held in env[0] and read with stride 0
+    if (drive->peak == prev_peak){
+        env[0] = drive->peak * drive->drive_coeff;
+        return 0;
+    }
+    for (uint32_t i = 0; i < inter->nframes; i++){
+        env[i] *= drive->drive_coeff;
+    }
+    return 1;
+}
+
+void overdrive_set(overdrive_parameters *drive, float drive_level, float gain_db){
+    float drive_coeff, norm_factor;
+    drive->drive = drive_level;
+    drive->gain_db = gain_db;
+    TRACE_INSTANT("overdrive_set");
+    drive_coeffs(drive_level, &drive_coeff, &norm_factor);
+    drive->inv_drive_coeff = 1.0f / drive_coeff;
+    //Ramp from wherever the previous change had reached
+    ramp_set(&drive->drive_ramp, drive->drive_coeff, drive_coeff);
+    ramp_set(&drive->norm_ramp, drive->norm_factor, norm_factor);
+    ramp_set(&drive->gain_ramp, drive->gain, db2lin(gain_db));
+}
+
+size_t overdrive_state_size(overdrive_parameters *drive){
+    return sizeof(overdrive_state) + (size_t)drive->window_max * sizeof(float);
+}
+
+void overdrive_snapshot(overdrive_parameters *drive, void *buffer){
+    overdrive_state *state = (overdrive_state*)buffer;
+    state->peak_window = drive->peak_window;
+    state->buffer_count = drive->buffer_count;
+    state->peak_count = drive->peak_count;
+    state->peak = drive->peak;
+    state->drive_coeff = drive->drive_coeff;
+    state->inv_drive_coeff = drive->inv_drive_coeff;
+    state->norm_factor = drive->norm_factor;
+    state->gain = drive->gain;
+    state->drive_ramp = drive->drive_ramp;
+    state->norm_ramp = drive->norm_ramp;
+    state->gain_ramp = drive->gain_ramp;
+    state->drive = drive->drive;
+    state->gain_db = drive->gain_db;
+    memcpy(state + 1, drive->window_store, drive->peak_window * sizeof(float));
+}
+
+int overdrive_restore(overdrive_parameters *drive, const void *buffer){
+    const overdrive_state *state = (const overdrive_state*)buffer;
+    if ((state->peak_window == 0) || (state->peak_window > drive->window_max)){
+        return 1;
+    }
+    drive->peak_window = state->peak_window;
+    drive->buffer_count = state->buffer_count;
+    drive->peak_count = state->peak_count;
+    drive->peak = state->peak;
+    drive->drive_coeff = state->drive_coeff;
+    drive->inv_drive_coeff = state->inv_drive_coeff;
+    drive->norm_factor = state->norm_factor;
+    drive->gain = state->gain;
+    drive->drive_ramp = state->drive_ramp;
+    drive->norm_ramp = state->norm_ramp;
+    drive->gain_ramp = state->gain_ramp;
+    drive->drive = state->drive;
+    drive->gain_db = state->gain_db;
+    memcpy(drive->window_store, state + 1, drive->peak_window * sizeof(float));
+    return 0;
+}
+
+void overdrive_sweep_default(overdrive_sweep_parameters *sweep, overdrive_parameters *drive){
+    //Copy Parameters into Every Lane
+    uint32_t k;
+    for (k = 0; k < SWEEP_LANES; k++){
+        sweep->drive[k] = drive->drive;
+        sweep->gain_db[k] = drive->gain_db;
+    }
+    sweep->lanes = SWEEP_LANES;
+}
+
+void overdrive_sweep_init(overdrive_sweep_parameters *sweep, interface_parameters *inter){
+    //Parameter Initialisation - Same expressions as overdrive_init(), one per lane
+    uint32_t k;
+    for (k = 0; k < SWEEP_LANES; k++){
+        sweep->gain[k] = db2lin(sweep->gain_db[k]);
+        drive_coeffs(sweep->drive[k], &sweep->drive_coeff[k], &sweep->norm_factor[k]);
+    }
+}
+
+int overdrive_sweep(jack_default_audio_sample_t *in, jack_default_audio_sample_t **out, overdrive_parameters *drive, overdrive_sweep_parameters *sweep, interface_parameters *inter){
+    float prev_peak = drive->peak;
+    float local_store[inter->nframes];
+    float *ls = local_store;
+    float env, norm, abs, curve, low, mid_pos, mid_neg, mid, high, y;
+    uint32_t i, k;
+    //Peak Calculations - Once for all variants
+    peak_calcs(in, peak_max_abs(in, inter->nframes), drive, inter, prev_peak, ls);
+    const int constant = (drive->peak == prev_peak);
+    if (constant){
+        for (i = 0; i < inter->nframes; i++){
+            ls[i] = drive->peak;
+        }
+    }
+    //Effect and Gain - Branch-free over each variant's block
+    for (k = 0; k < sweep->lanes; k++){
+        float coeff = sweep->drive_coeff[k];
+        float norm_factor = sweep->norm_factor[k];
+        float gain = sweep->gain[k];
+        jack_default_audio_sample_t *o = out[k];
+        //Constant Envelope - As overdrive(), so each variant matches its own instance
+        if (constant && (drive->peak * coeff >= FLT_MIN)){
+            overdrive_curve_block(in, o, drive->peak * coeff, gain / norm_factor, inter->nframes);
+            continue;
+        }
+        for (i = 0; i < inter->nframes; i++){
+            env = ls[i] * coeff;
+            norm = in[i] / env;
+            abs = fabsf(norm);
+            //Apply Static Characteristic - Every region evaluated, then selected
+            curve = 3.0f - (2.0f - abs * 3.0f) * (2.0f - abs * 3.0f);
+            low = 2.0f * in[i];
+            mid_pos = env * curve / 3.0f;
+            mid_neg = env * (-curve / 3.0f);
+            mid = (norm > 0.0f) ? mid_pos : mid_neg;
+            high = (norm > 0.0f) ? env : -env;
+            y = (abs <= (2.0f * THRESHOLD)) ? mid : high;
+            y = (abs <= THRESHOLD) ? low : y;
+            //Drive Coefficent Normalisation and Gain
+            y /= norm_factor;
+            y *= gain;
+            //Anomaly Detection - Zero, NaN and Inf fail (0 < abs <= FLT_MAX)
+            o[i] = ((abs > 0.0f) && (abs <= FLT_MAX)) ? y : 0.0f;
+        }
     }
     return 0;
 }
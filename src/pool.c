@@ -0,0 +1,228 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include "pool.h"
+#include "sample.h"
+#include "trace.h"
+
+//Spin-Wait Hint - Lets a hyperthread sibling run and saves power while polling
+static inline void pool_pause(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile("yield");
+#endif
+}
+
+//Owner's Pop - From the bottom, racing thieves only for the last task
+static inline int pool_pop(pool_deque *deque, pool_task *task){
+    int32_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int32_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (t > b){
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return 0;
+    }
+    *task = deque->tasks[b];
+    if (t == b){
+        int won = atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return 1;
+}
+
+//Thief's Steal - From the top, losing to the owner or another thief returns 0
+static inline int pool_steal(pool_deque *deque, pool_task *task){
+    int32_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int32_t b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b){
+        return 0;
+    }
+    *task = deque->tasks[t];
+    return atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+//Take one Task - Own deque first, then the others in turn from the next one along
+static inline int pool_take(pool_parameters *pool, uint32_t self, pool_task *task){
+    uint32_t n = pool->started + 1;
+    if (pool_pop(&pool->deques[self], task)){
+        return 1;
+    }
+    for (uint32_t k = 1; k < n; k++){
+        if (pool_steal(&pool->deques[(self + k) % n], task)){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static inline void pool_execute(pool_parameters *pool, pool_task *task){
+    task->function(task->arg);
+    atomic_fetch_sub_explicit(&pool->remaining, 1, memory_order_release);
+}
+
+static void *pool_thread(void *arg){
+    pool_worker *worker = (pool_worker*)arg;
+    pool_parameters *pool = worker->pool;
+    pool_task task;
+    uint32_t seen = atomic_load(&pool->generation);
+    TRACE_THREAD("pool worker");
+    //Denormals Flushed - Tasks are audio, as on the caller's thread
+    sample_flush_denormals();
+    for (;;){
+        //Wait for a Run - Spin, then sleep until pool_run() posts
+        uint32_t spin = 0;
+        while (atomic_load_explicit(&pool->generation, memory_order_acquire) == seen){
+            if (spin < POOL_SPIN){
+                pool_pause();
+                spin++;
+                continue;
+            }
+            atomic_store(&worker->sleeping, 1);
+            if (atomic_load(&pool->generation) != seen){
+                //Run started meanwhile - Unless its post is already on the way, nothing else will consume it
+                if (atomic_exchange(&worker->sleeping, 0)){
+                    break;
+                }
+            }
+            while ((sem_wait(&worker->wake) != 0) && (errno == EINTR)){
+            }
+        }
+        seen = atomic_load_explicit(&pool->generation, memory_order_acquire);
+        if (!atomic_load(&pool->running)){
+            break;
+        }
+        //Join the Run - Unless the caller already finished it, in which case its deques may be refilled at any time
+        atomic_fetch_add(&pool->busy, 1);
+        if (atomic_load(&pool->closed) != seen){
+            TRACE_BEGIN("pool run");
+            while (pool_take(pool, worker->index, &task)){
+                pool_execute(pool, &task);
+            }
+            TRACE_END("pool run");
+        }
+        atomic_fetch_sub(&pool->busy, 1);
+    }
+    return NULL;
+}
+
+void pool_default(pool_parameters *pool){
+    memset(pool, 0, sizeof(pool_parameters));
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    pool->nworkers = (cores > 1) ? (uint32_t)(cores - 1) : 0;
+    if (pool->nworkers > POOL_MAX_WORKERS){
+        pool->nworkers = POOL_MAX_WORKERS;
+    }
+    pool->priority = 0;
+}
+
+int pool_start(pool_parameters *pool){
+    pthread_attr_t attr;
+    struct sched_param param;
+    int rt = (pool->priority > 0);
+    if (pool->nworkers > POOL_MAX_WORKERS){
+        fprintf(stderr, "[ERROR] in pool, %u workers is more than the supported %u\n", pool->nworkers, POOL_MAX_WORKERS);
+        return 1;
+    }
+    atomic_store(&pool->running, 1);
+    pool->started = 0;
+    for (uint32_t w = 0; w < pool->nworkers; w++){
+        pool_worker *worker = &pool->workers[w];
+        worker->pool = pool;
+        worker->index = w + 1;
+        atomic_store(&worker->sleeping, 0);
+        if (sem_init(&worker->wake, 0, 0)){
+            fprintf(stderr, "[ERROR] in pool semaphore initialisation\n");
+            pool_stop(pool);
+            return 1;
+        }
+        //Real-Time Scheduling - As JACK's own thread, so a worker is never preempted by the rest of the system
+        int created = 0;
+        if (rt){
+            pthread_attr_init(&attr);
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+            param.sched_priority = pool->priority;
+            pthread_attr_setschedparam(&attr, &param);
+            created = (pthread_create(&worker->thread, &attr, pool_thread, worker) == 0);
+            pthread_attr_destroy(&attr);
+            if (!created){
+                printf("[USER-WARNING] Real-time scheduling not permitted for pool workers - Running at default priority\n");
+                rt = 0;
+            }
+        }
+        if (!created && pthread_create(&worker->thread, NULL, pool_thread, worker)){
+            sem_destroy(&worker->wake);
+            fprintf(stderr, "[ERROR] in pool thread creation\n");
+            pool_stop(pool);
+            return 1;
+        }
+        pool->started++;
+    }
+    return 0;
+}
+
+int pool_run(pool_parameters *pool, pool_task *tasks, uint32_t ntasks){
+    uint32_t k, n = pool->started + 1;
+    pool_task task;
+    if (ntasks > POOL_MAX_TASKS){
+        return 1;
+    }
+    //Deal the Tasks - No worker is inside a run here, so the deques are written plainly
+    for (k = 0; k < n; k++){
+        atomic_store_explicit(&pool->deques[k].top, 0, memory_order_relaxed);
+        atomic_store_explicit(&pool->deques[k].bottom, 0, memory_order_relaxed);
+    }
+    for (k = 0; k < ntasks; k++){
+        pool_deque *deque = &pool->deques[k % n];
+        int32_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+        deque->tasks[b] = tasks[k];
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    atomic_store_explicit(&pool->remaining, ntasks, memory_order_relaxed);
+    //Start the Run - Sleeping workers are posted, one futex wake each
+    uint32_t generation = atomic_fetch_add(&pool->generation, 1) + 1;
+    for (k = 0; k < pool->started; k++){
+        if (atomic_exchange(&pool->workers[k].sleeping, 0)){
+            sem_post(&pool->workers[k].wake);
+        }
+    }
+    //Work alongside the workers - Retrying until every task has finished, as a lost steal is not an empty deque
+    while (atomic_load_explicit(&pool->remaining, memory_order_acquire) > 0){
+        if (pool_take(pool, 0, &task)){
+            pool_execute(pool, &task);
+        }
+        else{
+            pool_pause();
+        }
+    }
+    //Close the Run - A worker still joining either sees it closed or is waited for
+    atomic_store(&pool->closed, generation);
+    while (atomic_load(&pool->busy) > 0){
+        pool_pause();
+    }
+    return 0;
+}
+
+void pool_stop(pool_parameters *pool){
+    if (!atomic_exchange(&pool->running, 0)){
+        return;
+    }
+    atomic_fetch_add(&pool->generation, 1);
+    for (uint32_t k = 0; k < pool->started; k++){
+        sem_post(&pool->workers[k].wake);
+    }
+    for (uint32_t k = 0; k < pool->started; k++){
+        pthread_join(pool->workers[k].thread, NULL);
+        sem_destroy(&pool->workers[k].wake);
+    }
+    pool->started = 0;
+}
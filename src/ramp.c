@@ -0,0 +1,89 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <math.h>
+#include "ramp.h"
+
+void ramp_init(ramp_parameters *ramp, float value, uint32_t shape, interface_parameters *inter){
+    ramp->shape = shape;
+    ramp->length = (uint32_t)(RAMP_T * (float)inter->fs);
+    if (ramp->length == 0){
+        ramp->length = 1;
+    }
+    ramp->remaining = 0;
+    ramp->stepping = RAMP_LINEAR;
+    ramp->current = value;
+    ramp->target = value;
+    ramp->step = 0.0f;
+    ramp->stride_step = 0.0f;
+}
+
+void ramp_update(ramp_parameters *ramp, interface_parameters *inter){
+    ramp->length = (uint32_t)(RAMP_T * (float)inter->fs);
+    if (ramp->length == 0){
+        ramp->length = 1;
+    }
+    if (ramp->remaining != 0){
+        ramp_set(ramp, ramp->current, ramp->target);
+    }
+}
+
+void ramp_set(ramp_parameters *ramp, float current, float target){
+    ramp->current = current;
+    ramp->target = target;
+    if (current == target){
+        ramp->remaining = 0;
+        return;
+    }
+    //Exponential ramps need both ends positive - Otherwise fall back to linear
+    if ((ramp->shape == RAMP_EXPONENTIAL) && (current > 0.0f) && (target > 0.0f)){
+        ramp->stepping = RAMP_EXPONENTIAL;
+        ramp->step = powf(target / current, 1.0f / (float)ramp->length);
+        ramp->stride_step = powf(ramp->step, (float)RAMP_STRIDE);
+    }
+    else{
+        ramp->stepping = RAMP_LINEAR;
+        ramp->step = (target - current) / (float)ramp->length;
+    }
+    ramp->remaining = ramp->length;
+}
+
+int ramp_settled(ramp_parameters *ramp){
+    return ramp->remaining == 0;
+}
+
+void ramp_block(ramp_parameters *ramp, float *values, uint32_t nframes){
+    uint32_t n = (ramp->remaining < nframes) ? ramp->remaining : nframes;
+    float current = ramp->current;
+    float step = ramp->step;
+    float stride_step = ramp->stride_step;
+    float target = ramp->target;
+    uint32_t i;
+    if (ramp->stepping == RAMP_LINEAR){
+        //Each value independent of the last - Vectorises directly
+        for (i = 0; i < n; i++){
+            values[i] = current + (float)(i + 1) * step;
+        }
+    }
+    else{
+        //First stride by repeated multiplication, then each value from the one RAMP_STRIDE back
+        //- No dependence inside a stride, so it vectorises
+        float value = current;
+        for (i = 0; (i < n) && (i < RAMP_STRIDE); i++){
+            value *= step;
+            values[i] = value;
+        }
+        for (i = RAMP_STRIDE; i < n; i++){
+            values[i] = values[i - RAMP_STRIDE] * stride_step;
+        }
+    }
+    //Remainder of the block holds the target
+    for (i = n; i < nframes; i++){
+        values[i] = target;
+    }
+    ramp->remaining -= n;
+    //Land exactly on the target once finished
+    ramp->current = (ramp->remaining == 0) ? target : values[n - 1];
+}
@@ -0,0 +1,390 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <string.h>
+#include "rripple.h"
+#include "graph.h"
+
+struct rripple{
+    uint32_t type;                      //Node Type for an effect, GRAPH_INPUT for a chain
+    uint32_t started;                   //Set once initialised (an effect) or compiled (a chain)
+    rripple *chain;                     //Chain running this effect, if any
+    interface_parameters inter;         //Sample rate and block, as the effects see them
+    union{
+        compressor_parameters comp;
+        overdrive_parameters drive;
+        delay_parameters dly;
+        octaver_parameters oct;
+    } fx;
+    //Chains Only
+    graph_parameters *graph;
+    rripple *members[GRAPH_MAX_NODES];  //Effect handles added - Started along with the chain
+    uint32_t nmembers;
+};
+
+static inline rripple *handle(uint32_t type, uint32_t fs, uint32_t block){
+    if ((fs == 0) || (fs > INTERFACE_MAX_FS) || (block < INTERFACE_MIN_NFRAMES) || (block > INTERFACE_MAX_NFRAMES) || ((block & (block - 1)) != 0)){
+        printf("[USER-ERROR] Invalid sample rate (%uHz) or block (%u frames) - Block must be a power of two in the range %u to %u\n",
+               fs, block, INTERFACE_MIN_NFRAMES, INTERFACE_MAX_NFRAMES);
+        return NULL;
+    }
+    //Aligned for the effect's hot state (see sample.h)
+    rripple *fx = (rripple*)sample_alloc(sizeof(rripple));
+    if (fx == NULL){
+        fprintf(stderr, "[ERROR] in rripple memory allocation\n");
+        return NULL;
+    }
+    memset(fx, 0, sizeof(rripple));
+    fx->type = type;
+    fx->inter.nperiods = 1;
+    fx->inter.nframes = block;
+    fx->inter.fs = fs;
+    return fx;
+}
+
+static inline int start(rripple *fx){
+    switch (fx->type){
+        case GRAPH_COMPRESSOR:
+            compressor_init(&fx->fx.comp, &fx->inter);
+            break;
+        case GRAPH_OVERDRIVE:
+            if (overdrive_init(&fx->fx.drive, &fx->inter)){
+                return 1;
+            }
+            break;
+        case GRAPH_DELAY:
+            if (delay_init(&fx->fx.dly, &fx->inter)){
+                return 1;
+            }
+            break;
+        case GRAPH_OCTAVER:
+            octaver_init(&fx->fx.oct, &fx->inter);
+            break;
+        default:
+            //Chain - Effects added by handle start first, as graph_compile expects them initialised
+            for (uint32_t m = 0; m < fx->nmembers; m++){
+                if (!fx->members[m]->started && start(fx->members[m])){
+                    return 1;
+                }
+            }
+            if (graph_compile(fx->graph, &fx->inter)){
+                return 1;
+            }
+            break;
+    }
+    fx->started = 1;
+    return 0;
+}
+
+//Effect Parameter - Written before the effect starts, ramped through its _set call after
+static inline int set_effect(uint32_t type, void *effect, uint32_t started, const char *key, float value, interface_parameters *inter){
+    //Range Check on a copy, so a rejected value changes nothing
+    union{
+        compressor_parameters comp;
+        overdrive_parameters drive;
+        delay_parameters dly;
+        octaver_parameters oct;
+    } check;
+    static const size_t sizes[5] = {0, sizeof(compressor_parameters), sizeof(overdrive_parameters), sizeof(delay_parameters), sizeof(octaver_parameters)};
+    memcpy(&check, effect, sizes[type]);
+    int found = graph_parameter(type, &check, key, value);
+    if (found){
+        printf("[USER-ERROR] %s '%s'\n", (found == 1) ? "Value out of range for" : "Unknown parameter", key);
+        return 1;
+    }
+    if (!started){
+        memcpy(effect, &check, sizes[type]);
+        return 0;
+    }
+    //Ramped Parameters - As the pedal changes them live
+    if ((type == GRAPH_COMPRESSOR) && ((strcmp(key, "compression_db") == 0) || (strcmp(key, "gain_db") == 0))){
+        compressor_set((compressor_parameters*)effect, check.comp.compression_db, check.comp.gain_db);
+        return 0;
+    }
+    if ((type == GRAPH_OVERDRIVE) && ((strcmp(key, "drive") == 0) || (strcmp(key, "gain_db") == 0))){
+        overdrive_set((overdrive_parameters*)effect, check.drive.drive, check.drive.gain_db);
+        return 0;
+    }
+    if ((type == GRAPH_DELAY) && ((strcmp(key, "time_t") == 0) || (strcmp(key, "tempo") == 0))){
+        delay_set_time((delay_parameters*)effect, check.dly.time_t, check.dly.tempo, inter);
+        return 0;
+    }
+    printf("[USER-ERROR] '%s' is fixed once processing starts\n", key);
+    return 1;
+}
+
+static inline int set_chain(rripple *chain, const char *key, float value){
+    graph_parameters *graph = chain->graph;
+    const char *dot = strchr(key, '.');
+    //Chain Parameters
+    if (dot == NULL){
+        if (chain->started){
+            printf("[USER-ERROR] '%s' is fixed once processing starts\n", key);
+            return 1;
+        }
+        if ((strcmp(key, "subblock") == 0) && (value >= 0.0f) && (value <= (float)INTERFACE_MAX_NFRAMES)){
+            uint32_t sub = (uint32_t)value;
+            if ((sub == 0) || ((sub >= INTERFACE_MIN_NFRAMES) && ((sub & (sub - 1)) == 0))){
+                graph->subblock = sub;
+                return 0;
+            }
+        }
+        printf("[USER-ERROR] Unknown parameter or value out of range for '%s'\n", key);
+        return 1;
+    }
+    //Node Parameters - "<node>.<parameter>"
+    size_t len = (size_t)(dot - key);
+    for (uint32_t v = 1; v < graph->nnodes; v++){
+        graph_node *node = &graph->nodes[v];
+        if ((strlen(node->name) != len) || (strncmp(node->name, key, len) != 0)){
+            continue;
+        }
+        //Bypass - Any node, switched at the next block
+        if (strcmp(dot + 1, "bypass") == 0){
+            if ((value != 0.0f) && (value != 1.0f)){
+                printf("[USER-ERROR] Value out of range for '%s' - 0 or 1\n", key);
+                return 1;
+            }
+            node->bypass = (uint32_t)value;
+            return 0;
+        }
+        if ((node->type == GRAPH_LOWPASS) || (node->type == GRAPH_HIGHPASS)){
+            if (chain->started || (strcmp(dot + 1, "cutoff") != 0) || (value < 20.0f) || (value > 20000.0f)){
+                printf("[USER-ERROR] Unknown or fixed parameter, or value out of range for '%s'\n", key);
+                return 1;
+            }
+            node->cutoff = value;
+            return 0;
+        }
+        if (node->type == GRAPH_MIX){
+            printf("[USER-ERROR] Mix levels are set in graph descriptions\n");
+            return 1;
+        }
+        //Effects a chain file created started when it loaded
+        uint32_t started = node->owned;
+        for (uint32_t m = 0; m < chain->nmembers; m++){
+            if (&chain->members[m]->fx == node->effect){
+                started = chain->members[m]->started;
+            }
+        }
+        return set_effect(node->type, node->effect, started, dot + 1, value, &graph->sub);
+    }
+    printf("[USER-ERROR] No node in chain for '%s'\n", key);
+    return 1;
+}
+
+static inline int run(rripple *fx, jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, interface_parameters *inter){
+    int err;
+    switch (fx->type){
+        case GRAPH_COMPRESSOR:
+            err = compressor(in, out, &fx->fx.comp, inter);
+            break;
+        case GRAPH_OVERDRIVE:
+            err = overdrive(in, out, &fx->fx.drive, inter);
+            //Advance Window Counters, as process() does after each block
+            fx->fx.drive.peak_count++;
+            fx->fx.drive.buffer_count++;
+            if (fx->fx.drive.buffer_count == fx->fx.drive.peak_window){
+                fx->fx.drive.buffer_count = 0;
+            }
+            break;
+        case GRAPH_DELAY:
+            err = delay(in, out, &fx->fx.dly, inter);
+            break;
+        case GRAPH_OCTAVER:
+            err = octaver(in, out, &fx->fx.oct, inter);
+            break;
+        default:
+            //Chain - Faulty nodes are already silenced
+            return graph_process(in, out, fx->graph, inter);
+    }
+    if (err){
+        memset(out, 0, inter->nframes * sizeof(jack_default_audio_sample_t));
+    }
+    return err;
+}
+
+uint32_t rripple_version(void){
+    return RRIPPLE_VERSION;
+}
+
+rripple *rripple_create(uint32_t type, uint32_t fs, uint32_t block){
+    if ((type < GRAPH_COMPRESSOR) || (type > GRAPH_OCTAVER)){
+        printf("[USER-ERROR] Invalid effect type %u\n", type);
+        return NULL;
+    }
+    rripple *fx = handle(type, fs, block);
+    if (fx == NULL){
+        return NULL;
+    }
+    switch (type){
+        case GRAPH_COMPRESSOR:
+            compressor_default(&fx->fx.comp);
+            break;
+        case GRAPH_OVERDRIVE:
+            overdrive_default(&fx->fx.drive);
+            break;
+        case GRAPH_DELAY:
+            delay_default(&fx->fx.dly);
+            break;
+        default:
+            octaver_default(&fx->fx.oct);
+            break;
+    }
+    return fx;
+}
+
+rripple *rripple_chain_create(uint32_t fs, uint32_t block){
+    rripple *chain = handle(GRAPH_INPUT, fs, block);
+    if (chain == NULL){
+        return NULL;
+    }
+    chain->graph = (graph_parameters*)malloc(sizeof(graph_parameters));
+    if (chain->graph == NULL){
+        fprintf(stderr, "[ERROR] in rripple chain memory allocation\n");
+        free(chain);
+        return NULL;
+    }
+    graph_default(chain->graph);
+    return chain;
+}
+
+rripple *rripple_chain_load(const char *path, uint32_t fs, uint32_t block){
+    rripple *chain = rripple_chain_create(fs, block);
+    if (chain == NULL){
+        return NULL;
+    }
+    if (graph_load(chain->graph, path, &chain->inter)){
+        rripple_destroy(chain);
+        return NULL;
+    }
+    return chain;
+}
+
+int rripple_chain_add(rripple *chain, const char *name, uint32_t type, const char *inputs, rripple *effect){
+    if ((chain == NULL) || (chain->graph == NULL) || chain->started){
+        printf("[USER-ERROR] Nodes are added to a chain before it starts processing\n");
+        return 1;
+    }
+    if (effect != NULL){
+        if ((effect->type != type) || (effect->chain != NULL) ||
+            (effect->inter.fs != chain->inter.fs) || (effect->inter.nframes != chain->inter.nframes)){
+            printf("[USER-ERROR] Effect for node '%s' must be of its type, in no other chain, and at the chain's sample rate and block\n", name);
+            return 1;
+        }
+    }
+    else if (type <= GRAPH_OCTAVER){
+        printf("[USER-ERROR] Node '%s' needs an effect handle\n", name);
+        return 1;
+    }
+    if (graph_add(chain->graph, name, type, inputs, (effect != NULL) ? (void*)&effect->fx : NULL)){
+        return 1;
+    }
+    if (effect != NULL){
+        effect->chain = chain;
+        chain->members[chain->nmembers++] = effect;
+    }
+    return 0;
+}
+
+int rripple_set(rripple *fx, const char *key, float value){
+    if (fx->graph != NULL){
+        return set_chain(fx, key, value);
+    }
+    return set_effect(fx->type, &fx->fx, fx->started, key, value, &fx->inter);
+}
+
+int rripple_process(rripple *fx, const float *in, float *out, uint64_t nframes){
+    if (fx->chain != NULL){
+        printf("[USER-ERROR] Effect is run by its chain\n");
+        return 1;
+    }
+    if (!fx->started && start(fx)){
+        return 1;
+    }
+    //Denormals Flushed as on the pedal, and the caller's mode put back after
+    uint64_t mode = sample_flush_denormals();
+    //Whole Blocks, then a Shorter Last Block - Effects are only ever given up to the block they were set up for
+    interface_parameters tail = fx->inter;
+    uint32_t block = fx->inter.nframes;
+    int err = 0;
+    for (uint64_t offset = 0; offset < nframes; offset += block){
+        interface_parameters *inter = &fx->inter;
+        if (nframes - offset < block){
+            tail.nframes = (uint32_t)(nframes - offset);
+            inter = &tail;
+        }
+        //Effects never write their input, so in is only cast for their signature
+        err |= run(fx, (jack_default_audio_sample_t*)&in[offset], &out[offset], inter);
+    }
+    sample_restore_denormals(mode);
+    return err;
+}
+
+int rripple_process_automation(rripple *fx, const float *in, float *out, uint64_t nframes, const rripple_point *points, uint32_t npoints){
+    if (fx->chain != NULL){
+        printf("[USER-ERROR] Effect is run by its chain\n");
+        return 1;
+    }
+    if (!fx->started && start(fx)){
+        return 1;
+    }
+    uint64_t mode = sample_flush_denormals();
+    //Blocks as rripple_process() - Only a block with points in it is split, so the rest stay on the same grid
+    interface_parameters part = fx->inter;
+    uint32_t block = fx->inter.nframes;
+    uint32_t p = 0;
+    int err = 0;
+    for (uint64_t offset = 0; offset < nframes; offset += block){
+        uint64_t end = (nframes - offset < block) ? nframes : offset + block;
+        uint64_t done = offset;
+        //Points in this Block - The frames before each run first, points at the same frame share one split
+        for (; (p < npoints) && (points[p].frame < end); p++){
+            if (points[p].frame > done){
+                part.nframes = (uint32_t)(points[p].frame - done);
+                err |= run(fx, (jack_default_audio_sample_t*)&in[done], &out[done], &part);
+                done = points[p].frame;
+            }
+            if (rripple_set(fx, points[p].key, points[p].value)){
+                err |= 2;
+            }
+        }
+        if ((done == offset) && (end - offset == block)){
+            err |= run(fx, (jack_default_audio_sample_t*)&in[offset], &out[offset], &fx->inter);
+        }
+        else if (done < end){
+            part.nframes = (uint32_t)(end - done);
+            err |= run(fx, (jack_default_audio_sample_t*)&in[done], &out[done], &part);
+        }
+    }
+    //Points at or past the End - Applied after the last frame, ready for the next call
+    for (; p < npoints; p++){
+        if (rripple_set(fx, points[p].key, points[p].value)){
+            err |= 2;
+        }
+    }
+    sample_restore_denormals(mode);
+    return err;
+}
+
+void rripple_destroy(rripple *fx){
+    if (fx == NULL){
+        return;
+    }
+    if (fx->graph != NULL){
+        graph_free(fx->graph);
+        free(fx->graph);
+        for (uint32_t m = 0; m < fx->nmembers; m++){
+            fx->members[m]->chain = NULL;
+        }
+    }
+    else if (fx->started && (fx->type == GRAPH_OVERDRIVE)){
+        free(fx->fx.drive.window_store);
+    }
+    else if (fx->started && (fx->type == GRAPH_DELAY)){
+        free(fx->fx.dly.ring);
+    }
+    free(fx);
+}
@@ -0,0 +1,154 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trace.h"
+
+atomic_int trace_enabled = 0;
+
+#ifdef TRACE
+
+static trace_ring rings[TRACE_THREADS];
+static _Atomic uint32_t nrings = 0;
+static _Atomic uint64_t lost = 0;
+static _Thread_local trace_ring *local = NULL;
+static uint64_t origin_ticks = 0, origin_ns = 0;
+
+static inline uint64_t monotonic(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static inline trace_ring *claim(){
+    uint32_t k = atomic_fetch_add_explicit(&nrings, 1, memory_order_relaxed);
+    if (k >= TRACE_THREADS){
+        return NULL;
+    }
+    return &rings[k];
+}
+
+static inline void record(const char *name, uint32_t phase, uint64_t time, uint64_t end){
+    trace_ring *ring = local;
+    if (ring == NULL){
+        ring = local = claim();
+        if (ring == NULL){
+            atomic_fetch_add_explicit(&lost, 1, memory_order_relaxed);
+            return;
+        }
+    }
+    uint64_t n = atomic_load_explicit(&ring->count, memory_order_relaxed);
+    trace_event *event = &ring->events[n & (TRACE_RING - 1)];
+    event->time = time;
+    event->end = end;
+    event->name = name;
+    event->phase = phase;
+    atomic_store_explicit(&ring->count, n + 1, memory_order_release);
+}
+
+void trace_record_event(const char *name, uint32_t phase){
+    record(name, phase, trace_ticks(), 0);
+}
+
+void trace_record_span(const char *name, uint64_t start, uint64_t end){
+    record(name, 'X', start, end);
+}
+
+void trace_thread(const char *name){
+    if (local == NULL){
+        local = claim();
+    }
+    if (local != NULL){
+        local->name = name;
+    }
+}
+
+void trace_enable(int enable){
+    //Origin fixed at the first start, so paused stretches show as gaps
+    if (enable && (origin_ns == 0)){
+        origin_ns = monotonic();
+        origin_ticks = trace_ticks();
+    }
+    atomic_store(&trace_enabled, enable);
+}
+
+uint64_t trace_count(void){
+    uint64_t total = 0;
+    uint32_t n = atomic_load(&nrings);
+    for (uint32_t k = 0; (k < n) && (k < TRACE_THREADS); k++){
+        uint64_t count = atomic_load_explicit(&rings[k].count, memory_order_acquire);
+        total += (count < TRACE_RING) ? count : TRACE_RING;
+    }
+    return total;
+}
+
+int trace_dump(const char *path){
+    FILE *file = fopen(path, "w");
+    if (file == NULL){
+        fprintf(stderr, "[ERROR] in opening trace file '%s'\n", path);
+        return 1;
+    }
+    //Tick Rate over the whole recording
+    double ns_per_tick = 1.0;
+    uint64_t elapsed_ticks = trace_ticks() - origin_ticks;
+    if (elapsed_ticks > 0){
+        ns_per_tick = (double)(monotonic() - origin_ns) / (double)elapsed_ticks;
+    }
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"raspberry_ripple\"}}");
+    uint32_t n = atomic_load(&nrings);
+    for (uint32_t k = 0; (k < n) && (k < TRACE_THREADS); k++){
+        trace_ring *ring = &rings[k];
+        uint64_t count = atomic_load_explicit(&ring->count, memory_order_acquire);
+        uint64_t first = (count > TRACE_RING) ? count - TRACE_RING : 0;
+        char fallback[16];
+        snprintf(fallback, sizeof(fallback), "thread %u", k);
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", k, (ring->name != NULL) ? ring->name : fallback);
+        for (uint64_t e = first; e < count; e++){
+            trace_event *event = &ring->events[e & (TRACE_RING - 1)];
+            //Timestamps in us, as the format expects
+            double ts = 1e-3 * ns_per_tick * (double)(int64_t)(event->time - origin_ticks);
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u", event->name, (char)event->phase, ts, k);
+            if (event->phase == 'X'){
+                fprintf(file, ",\"dur\":%.3f}", 1e-3 * ns_per_tick * (double)(event->end - event->time));
+            }
+            else{
+                fprintf(file, "%s}", (event->phase == 'i') ? ",\"s\":\"t\"" : "");
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    if (atomic_load(&lost) > 0){
+        printf("[USER-WARNING] Trace events from more than %u threads were not recorded\n", TRACE_THREADS);
+    }
+    return fclose(file) != 0;
+}
+
+#else
+
+//Not Compiled In - Rebuild with make TRACE=1
+void trace_record_event(const char *name, uint32_t phase){
+}
+
+void trace_record_span(const char *name, uint64_t start, uint64_t end){
+}
+
+void trace_thread(const char *name){
+}
+
+void trace_enable(int enable){
+}
+
+uint64_t trace_count(void){
+    return 0;
+}
+
+int trace_dump(const char *path){
+    printf("[USER-WARNING] Tracing is not compiled in, rebuild with make TRACE=1 to write '%s'\n", path);
+    return 1;
+}
+
+#endif
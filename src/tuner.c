@@ -0,0 +1,242 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "tuner.h"
+
+#define PI 3.14159265f
+#define TUNER_GATE 0.000001f    //Quietest Analysis Frame (mean square) - Silence reports no pitch
+#define TUNER_MAX_F 1000.0f     //Highest Fundamental searched (Hz)
+#define TUNER_SLEEP 5000        //Analysis Thread Poll Interval (us) - Far shorter than the ring
+
+static const char *note_names[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+static inline uint64_t pack(float freq, float clarity){
+    uint32_t f, c;
+    memcpy(&f, &freq, sizeof(f));
+    memcpy(&c, &clarity, sizeof(c));
+    return ((uint64_t)c << 32) | f;
+}
+
+static inline void lowpass(float *coeffs, float fc, float q, float fs){
+    //Butterworth Section - b0, b1, b2, a1, a2 normalised by a0
+    float w = 2.0f * PI * fc / fs;
+    float alpha = sinf(w) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    coeffs[0] = 0.5f * (1.0f - cosf(w)) / a0;
+    coeffs[1] = (1.0f - cosf(w)) / a0;
+    coeffs[2] = coeffs[0];
+    coeffs[3] = -2.0f * cosf(w) / a0;
+    coeffs[4] = (1.0f - alpha) / a0;
+}
+
+static inline void yin(tuner_parameters *tuner){
+    const uint32_t width = TUNER_FRAME - TUNER_TAU;
+    float rate = (float)tuner->fs / (float)tuner->decimation;
+    float *x = tuner->frame;
+    float *d = tuner->diff;
+    float energy = 0.0f, running = 0.0f, diff, delta, freq = 0.0f, clarity = 0.0f;
+    uint32_t tau, j;
+    for (j = 0; j < TUNER_FRAME; j++){
+        energy += x[j] * x[j];
+    }
+    if (energy < TUNER_GATE * (float)TUNER_FRAME){
+        atomic_store_explicit(&tuner->result, pack(0.0f, 0.0f), memory_order_release);
+        return;
+    }
+    //Cumulative Mean Normalised Difference Function
+    d[0] = 1.0f;
+    for (tau = 1; tau < TUNER_TAU; tau++){
+        diff = 0.0f;
+        for (j = 0; j < width; j++){
+            delta = x[j] - x[j + tau];
+            diff += delta * delta;
+        }
+        running += diff;
+        d[tau] = (running > 0.0f) ? diff * (float)tau / running : 1.0f;
+    }
+    //Absolute Threshold - First dip below it, followed down to its minimum
+    uint32_t tau_min = (uint32_t)(rate / TUNER_MAX_F);
+    if (tau_min < 2){
+        tau_min = 2;
+    }
+    for (tau = tau_min; tau < TUNER_TAU - 1; tau++){
+        if (d[tau] < tuner->threshold){
+            while ((tau + 1 < TUNER_TAU - 1) && (d[tau + 1] < d[tau])){
+                tau++;
+            }
+            //Parabolic Interpolation between frames
+            float den = d[tau - 1] - 2.0f * d[tau] + d[tau + 1];
+            float shift = (den > 0.0f) ? 0.5f * (d[tau - 1] - d[tau + 1]) / den : 0.0f;
+            freq = rate / ((float)tau + shift);
+            clarity = 1.0f - d[tau];
+            break;
+        }
+    }
+    atomic_store_explicit(&tuner->result, pack(freq, clarity), memory_order_release);
+}
+
+static void *tuner_thread(void *arg){
+    tuner_parameters *tuner = (tuner_parameters*)arg;
+    //Default scheduling - Always below JACK's real-time thread
+    while (atomic_load_explicit(&tuner->running, memory_order_relaxed)){
+        tuner_analyse(tuner);
+        usleep(TUNER_SLEEP);
+    }
+    return NULL;
+}
+
+static inline void retune(tuner_parameters *tuner, uint32_t fs){
+    tuner->fs = fs;
+    tuner->decimation = fs / TUNER_RATE;
+    if (tuner->decimation == 0){
+        tuner->decimation = 1;
+    }
+    //Anti-Aliasing - 4th order Butterworth at half the decimated Nyquist
+    float rate = (float)fs / (float)tuner->decimation;
+    lowpass(tuner->biquad[0], 0.25f * rate, 0.5412f, (float)fs);
+    lowpass(tuner->biquad[1], 0.25f * rate, 1.3066f, (float)fs);
+    memset(tuner->z, 0, sizeof(tuner->z));
+    tuner->phase = 0;
+    tuner->fill = 0;
+}
+
+void tuner_default(tuner_parameters *tuner){
+    //Set Default Parameters
+    tuner->enabled = 0;
+    tuner->reference = 440.0f;
+    tuner->threshold = 0.15f;
+    tuner->ring = NULL;
+    atomic_init(&tuner->running, 0);
+}
+
+int tuner_init(tuner_parameters *tuner, interface_parameters *inter){
+    //Parameter Initialisation
+    retune(tuner, inter->fs);
+    //Ring Buffer - Single producer (process), single consumer (analysis thread)
+    tuner->ring = (float*)calloc(TUNER_RING, sizeof(float));
+    if (tuner->ring == NULL){
+        fprintf(stderr, "[ERROR] in tuner->ring memory allocation\n");
+        return 1;
+    }
+    atomic_init(&tuner->write_pos, 0);
+    atomic_init(&tuner->read_pos, 0);
+    atomic_init(&tuner->dropped, 0);
+    atomic_init(&tuner->rate, inter->fs);
+    atomic_init(&tuner->result, pack(0.0f, 0.0f));
+    atomic_init(&tuner->running, 0);
+    return 0;
+}
+
+void tuner_update(tuner_parameters *tuner, interface_parameters *inter){
+    atomic_store_explicit(&tuner->rate, inter->fs, memory_order_release);
+}
+
+void tuner_push(jack_default_audio_sample_t *in, tuner_parameters *tuner, interface_parameters *inter){
+    uint32_t w = atomic_load_explicit(&tuner->write_pos, memory_order_relaxed);
+    uint32_t r = atomic_load_explicit(&tuner->read_pos, memory_order_acquire);
+    //Full - Drop the block rather than wait on the analysis thread
+    if ((w - r) + inter->nframes > TUNER_RING){
+        atomic_fetch_add_explicit(&tuner->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    uint32_t start = w & (TUNER_RING - 1);
+    uint32_t first = TUNER_RING - start;
+    if (first >= inter->nframes){
+        memcpy(&tuner->ring[start], in, inter->nframes * sizeof(float));
+    }
+    else{
+        memcpy(&tuner->ring[start], in, first * sizeof(float));
+        memcpy(tuner->ring, &in[first], (inter->nframes - first) * sizeof(float));
+    }
+    atomic_store_explicit(&tuner->write_pos, w + inter->nframes, memory_order_release);
+}
+
+int tuner_analyse(tuner_parameters *tuner){
+    uint32_t w = atomic_load_explicit(&tuner->write_pos, memory_order_acquire);
+    uint32_t r = atomic_load_explicit(&tuner->read_pos, memory_order_relaxed);
+    float x, y;
+    int published = 0;
+    uint32_t s;
+    //Sample Rate Change - Filters and the frame restart at the new rate
+    uint32_t fs = atomic_load_explicit(&tuner->rate, memory_order_acquire);
+    if (fs != tuner->fs){
+        retune(tuner, fs);
+    }
+    while (r != w){
+        x = tuner->ring[r & (TUNER_RING - 1)];
+        r++;
+        //Anti-Aliasing Filter - Transposed direct form II sections
+        for (s = 0; s < 2; s++){
+            float *c = tuner->biquad[s];
+            float *z = tuner->z[s];
+            y = c[0] * x + z[0];
+            z[0] = c[1] * x - c[3] * y + z[1];
+            z[1] = c[2] * x - c[4] * y;
+            x = y;
+        }
+        //Anomaly Detection - Keep NaN and Inf out of the filter state
+        if (!(fabsf(x) < 1.0e6f)){
+            memset(tuner->z, 0, sizeof(tuner->z));
+            x = 0.0f;
+        }
+        //Decimation
+        if (++tuner->phase < tuner->decimation){
+            continue;
+        }
+        tuner->phase = 0;
+        tuner->frame[tuner->fill++] = x;
+        if (tuner->fill == TUNER_FRAME){
+            yin(tuner);
+            memmove(tuner->frame, &tuner->frame[TUNER_HOP], (TUNER_FRAME - TUNER_HOP) * sizeof(float));
+            tuner->fill = TUNER_FRAME - TUNER_HOP;
+            published = 1;
+        }
+    }
+    atomic_store_explicit(&tuner->read_pos, r, memory_order_release);
+    return published;
+}
+
+int tuner_start(tuner_parameters *tuner){
+    atomic_store(&tuner->running, 1);
+    if (pthread_create(&tuner->thread, NULL, tuner_thread, tuner)){
+        atomic_store(&tuner->running, 0);
+        fprintf(stderr, "[ERROR] in tuner thread creation\n");
+        return 1;
+    }
+    return 0;
+}
+
+void tuner_stop(tuner_parameters *tuner){
+    if (atomic_exchange(&tuner->running, 0)){
+        pthread_join(tuner->thread, NULL);
+    }
+}
+
+int tuner_read(tuner_parameters *tuner, float *freq, float *cents, char *name){
+    uint64_t result = atomic_load_explicit(&tuner->result, memory_order_acquire);
+    uint32_t f = (uint32_t)result;
+    memcpy(freq, &f, sizeof(f));
+    if (!((*freq > 8.0f) && (*freq < 12544.0f))){
+        *cents = 0.0f;
+        name[0] = '\0';
+        return 0;
+    }
+    //Nearest Equal-Tempered Note
+    float midi = 69.0f + 12.0f * log2f(*freq / tuner->reference);
+    //Freq range above keeps note within MIDI 0 to 127, so the name always fits
+    uint32_t note = (uint32_t)lroundf(midi) & 127;
+    *cents = 100.0f * (midi - (float)note);
+    snprintf(name, 5, "%s%d", note_names[note % 12], (int)(note / 12) - 1);
+    return 1;
+}
+
+void tuner_free(tuner_parameters *tuner){
+    tuner_stop(tuner);
+    free(tuner->ring);
+    tuner->ring = NULL;
+}
@@ -0,0 +1,171 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdlib.h>
+#include <string.h>
+#include "wav.h"
+
+#define WAV_PCM 1
+#define WAV_FLOAT 3
+#define WAV_EXTENSIBLE 0xFFFE
+
+static inline uint32_t le16(const uint8_t *b){
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8);
+}
+
+static inline uint32_t le32(const uint8_t *b){
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static inline float wav_sample(const uint8_t *b, uint32_t format, uint32_t bits){
+    //Convert one little-endian sample to float
+    if ((format == WAV_FLOAT) && (bits == 32)){
+        union {uint32_t u; float f;} v;
+        v.u = le32(b);
+        return v.f;
+    }
+    else if (bits == 16){
+        return (float)(int16_t)le16(b) / 32768.0f;
+    }
+    else if (bits == 24){
+        return (float)((int32_t)(le32(b) << 8) >> 8) / 8388608.0f;
+    }
+    else{
+        return (float)(int32_t)le32(b) / 2147483648.0f;
+    }
+}
+
+int wav_read(const char *path, wav_file *wav){
+    //Read Whole File
+    FILE *f = fopen(path, "rb");
+    if (f == NULL){
+        fprintf(stderr, "[ERROR] in opening WAV file '%s'\n", path);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *file = (uint8_t*)malloc(size);
+    if (file == NULL){
+        fprintf(stderr, "[ERROR] in WAV file memory allocation\n");
+        fclose(f);
+        return 1;
+    }
+    if ((size < 12) || (fread(file, 1, size, f) != (size_t)size) ||
+        (memcmp(file, "RIFF", 4) != 0) || (memcmp(file + 8, "WAVE", 4) != 0)){
+        fprintf(stderr, "[ERROR] '%s' is not a RIFF WAVE file\n", path);
+        fclose(f);
+        free(file);
+        return 1;
+    }
+    fclose(f);
+    //Find fmt and data Chunks
+    uint32_t format = 0, bits = 0, data_len = 0;
+    uint8_t *data = NULL;
+    long pos = 12;
+    wav->channels = 0;
+    while (pos + 8 <= size){
+        uint32_t chunk_len = le32(file + pos + 4);
+        uint8_t *chunk = file + pos + 8;
+        if ((long)chunk_len > size - pos - 8){
+            chunk_len = (uint32_t)(size - pos - 8);
+        }
+        if ((memcmp(file + pos, "fmt ", 4) == 0) && (chunk_len >= 16)){
+            format = le16(chunk);
+            wav->channels = le16(chunk + 2);
+            wav->fs = le32(chunk + 4);
+            bits = le16(chunk + 14);
+            if ((format == WAV_EXTENSIBLE) && (chunk_len >= 26)){
+                format = le16(chunk + 24);
+            }
+        }
+        else if (memcmp(file + pos, "data", 4) == 0){
+            data = chunk;
+            data_len = chunk_len;
+        }
+        pos += 8 + chunk_len + (chunk_len & 1);
+    }
+    if ((data == NULL) || (wav->channels == 0) ||
+        !(((format == WAV_PCM) && ((bits == 16) || (bits == 24) || (bits == 32))) ||
+          ((format == WAV_FLOAT) && (bits == 32)))){
+        fprintf(stderr, "[ERROR] '%s' is not 16/24/32-bit PCM or 32-bit float\n", path);
+        free(file);
+        return 1;
+    }
+    //Convert First Channel to Float
+    uint32_t frame_bytes = wav->channels * bits / 8;
+    wav->length = data_len / frame_bytes;
+    wav->data = (float*)malloc((wav->length + 1) * sizeof(float));
+    if (wav->data == NULL){
+        fprintf(stderr, "[ERROR] in wav->data memory allocation\n");
+        free(file);
+        return 1;
+    }
+    uint32_t i;
+    for (i = 0; i < wav->length; i++){
+        wav->data[i] = wav_sample(data + i * frame_bytes, format, bits);
+    }
+    free(file);
+    return 0;
+}
+
+static inline void put16(uint8_t *b, uint32_t v){
+    b[0] = (uint8_t)v;
+    b[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t *b, uint32_t v){
+    b[0] = (uint8_t)v;
+    b[1] = (uint8_t)(v >> 8);
+    b[2] = (uint8_t)(v >> 16);
+    b[3] = (uint8_t)(v >> 24);
+}
+
+int wav_write(const char *path, wav_file *wav){
+    //Header - RIFF, fmt (float, mono) and data chunk header
+    uint8_t header[44];
+    uint32_t data_len = wav->length * 4;
+    memcpy(header, "RIFF", 4);
+    put32(header + 4, 36 + data_len);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(header + 16, 16);
+    put16(header + 20, WAV_FLOAT);
+    put16(header + 22, 1);
+    put32(header + 24, wav->fs);
+    put32(header + 28, wav->fs * 4);
+    put16(header + 32, 4);
+    put16(header + 34, 32);
+    memcpy(header + 36, "data", 4);
+    put32(header + 40, data_len);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL){
+        fprintf(stderr, "[ERROR] in opening WAV file '%s' for writing\n", path);
+        return 1;
+    }
+    //Samples - Little-endian, converted in chunks
+    uint8_t chunk[4096];
+    uint32_t i = 0, n, k;
+    int err = (fwrite(header, 1, sizeof(header), f) != sizeof(header));
+    while ((i < wav->length) && !err){
+        n = (wav->length - i < sizeof(chunk) / 4) ? wav->length - i : sizeof(chunk) / 4;
+        for (k = 0; k < n; k++){
+            union {uint32_t u; float f;} v;
+            v.f = wav->data[i + k];
+            put32(chunk + 4 * k, v.u);
+        }
+        err = (fwrite(chunk, 4, n, f) != n);
+        i += n;
+    }
+    if (fclose(f) || err){
+        fprintf(stderr, "[ERROR] in writing WAV file '%s'\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+void wav_free(wav_file *wav){
+    free(wav->data);
+    wav->data = NULL;
+    wav->length = 0;
+}
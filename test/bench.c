@@ -0,0 +1,1729 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stddef.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <jack/jack.h>
+#include <math.h>
+#include "compressor.h"
+#include "overdrive.h"
+#include "peak.h"
+#include "delay.h"
+#include "octaver.h"
+#include "tuner.h"
+#include "graph.h"
+#include "midi.h"
+#include "pool.h"
+#include "trace.h"
+#include "interface.h"
+#include "test.h"
+
+#define PI 3.14159265f
+#define BENCH_RIGS 8            //Rigs in the pool benchmark
+#define BENCH_INSTANCES 256     //Most Instances in the layout benchmark
+#define BENCH_DENORMAL 1e-40f   //Subnormal Sample in the anomaly benchmark - Below FLT_MIN
+#define BENCH_SQUARE 110.0f     //Full-Scale Square Wave in the anomaly benchmark (Hz)
+
+interface_parameters *inter;
+float seconds = 10.0f;
+char *trace_path = NULL;
+
+static inline void print_help(){
+    printf("\n"
+           "Usage:\n"
+           "  bench <benchmark> [Additional Arguments]\n"
+           "\n"
+           "Where:\n"
+           "  benchmark             Benchmark to run - Default is all\n"
+           "    effects             Each effect against the real-time period budget\n"
+           "    anomaly             Each effect fed zeros, NaN, Inf, denormals and full-scale squares, with worst block times\n"
+           "    sweep               6 compressor and 6 overdrive variants, serially and as one parameter sweep\n"
+           "    state               Fork a render from a state snapshot and check the continuation is exact\n"
+           "    graph               Serial chain as a compiled graph against direct calls, and a split-band graph\n"
+           "    pool                8 rigs one after another and across the worker pool, as rripple_host runs them\n"
+           "    layout              1 to 256 compressor -> overdrive instances in turn, with cache misses per block\n"
+           "    subblock            Graph split into 16 frame sub-blocks, against direct calls at a 16 frame period\n"
+           "    control             Compressor at control rate against every sample, with the error introduced\n"
+           "    stages              Compressor as curve, smoothing and apply stages, timed per stage\n"
+           "    peak                Overdrive peak kernels, scalar against vectorised, with the speedup of each\n"
+           "    midi                MIDI changes applied at their frame, checked exact, and the cost of splitting periods\n"
+           "    trace               Tracer overhead on a compiled graph - Needs a build with make TRACE=1\n"
+           "    resize              Change period and sample rate mid-stream, timing the effect updates\n"
+           "    tuner               Tuner cost on the real-time path and in analysis, and accuracy per string\n"
+           "\n"
+           "Additional Arguments (u and f denote unsigned integer and float values respectively:\n"
+           "\n"
+           "    [--nframes u]       Frames per Period - Must be in the range 1 to 4096\n"
+           "                        Default is 64\n"
+           "    [--fs u]            Sample Rate (Hz) - Must be in the range 44100 to 192000\n"
+           "                        Default is 48000\n"
+           "    [--seconds f]       Length of synthetic test signal (s) - Must be more than 0\n"
+           "                        Default is 10.0f\n"
+           "    [--trace s]         Chrome Trace File for the trace benchmark's recording\n"
+           "                        Default is none\n"
+           "\n");
+}
+
+static inline double bench_time(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+static inline void bench_report(const char *name, double elapsed, uint32_t blocks){
+    double audio = (double)blocks * (double)inter->nframes / (double)inter->fs;
+    printf("  %-36s %10.1f ns/block %8.1fx real-time\n", name, 1e9 * elapsed / (double)blocks, audio / elapsed);
+}
+
+static inline void bench_budget(const char *name, double elapsed, uint32_t blocks){
+    //Time per block as a share of the real-time period budget
+    double budget = (double)inter->nframes / (double)inter->fs;
+    double block = elapsed / (double)blocks;
+    printf("  %-36s %10.1f ns/block %7.2f%% of %.0fus budget\n", name, 1e9 * block, 100.0 * block / budget, 1e6 * budget);
+}
+
+static inline float bench_error(float *a, float *b, uint32_t n){
+    float err = 0.0f;
+    for (uint32_t i = 0; i < n; i++){
+        if (fabsf(a[i] - b[i]) > err){
+            err = fabsf(a[i] - b[i]);
+        }
+    }
+    return err;
+}
+
+//Synthetic Bass Signal - Plucked E1, A1, D2 and G2 with a silent gap between notes
+static inline void bench_signal(float *x, uint32_t n){
+    const float notes[4] = {41.20f, 55.00f, 73.42f, 98.00f};
+    uint32_t note_len = inter->fs;
+    for (uint32_t i = 0; i < n; i++){
+        uint32_t note = (i / note_len) % 4;
+        float t = (float)(i % note_len) / (float)inter->fs;
+        if (t > 0.9f){
+            x[i] = 0.0f;
+        }
+        else{
+            float f = notes[note];
+            x[i] = 0.6f * expf(-3.0f * t) * (sinf(2.0f * PI * f * t) + 0.4f * sinf(4.0f * PI * f * t) + 0.1f * sinf(6.0f * PI * f * t));
+        }
+    }
+}
+
+//Advance overdrive window counters, as process() does after each block
+static inline void bench_window(overdrive_parameters *drive){
+    drive->peak_count++;
+    drive->buffer_count++;
+    if (drive->buffer_count == drive->peak_window){
+        drive->buffer_count = 0;
+    }
+}
+
+//Compressor Variants - K independent instances serially, then one sweep
+static inline int bench_compressor_sweep(float *x, uint32_t blocks, const char *title, compressor_sweep_parameters *sweep, float *serial, float *swept){
+    uint32_t n = blocks * inter->nframes;
+    uint32_t b, k;
+    float *out[SWEEP_LANES];
+    double begin, serial_t, sweep_t;
+    compressor_parameters comp[SWEEP_LANES];
+    for (k = 0; k < sweep->lanes; k++){
+        compressor_default(&comp[k]);
+        comp[k].ratio = sweep->ratio[k];
+        comp[k].knee_width = sweep->knee_width[k];
+        comp[k].threshold = sweep->threshold[k];
+        comp[k].attack_t = sweep->attack_t[k];
+        comp[k].release_t = sweep->release_t[k];
+        comp[k].compression_db = sweep->compression_db[k];
+        comp[k].gain_db = sweep->gain_db[k];
+        compressor_init(&comp[k], inter);
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        for (k = 0; k < sweep->lanes; k++){
+            compressor(&x[b * inter->nframes], &serial[k * n + b * inter->nframes], &comp[k], inter);
+        }
+    }
+    serial_t = bench_time() - begin;
+    compressor_sweep_init(sweep, inter);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        for (k = 0; k < sweep->lanes; k++){
+            out[k] = &swept[k * n + b * inter->nframes];
+        }
+        compressor_sweep(&x[b * inter->nframes], out, sweep, inter);
+    }
+    sweep_t = bench_time() - begin;
+    printf("\n%s\n", title);
+    bench_report("serial", serial_t, blocks);
+    bench_report("sweep", sweep_t, blocks);
+    printf("  speedup %.2fx, max abs difference %g\n", serial_t / sweep_t, bench_error(serial, swept, sweep->lanes * n));
+    return 0;
+}
+
+//Overdrive Variants - K independent instances serially, then one sweep sharing the peak envelope
+static inline int bench_overdrive_sweep(float *x, uint32_t blocks, const char *title, overdrive_sweep_parameters *sweep, float *serial, float *swept){
+    uint32_t n = blocks * inter->nframes;
+    uint32_t b, k;
+    float *out[SWEEP_LANES];
+    double begin, serial_t, sweep_t;
+    overdrive_parameters drive[SWEEP_LANES], shared;
+    for (k = 0; k < sweep->lanes; k++){
+        overdrive_default(&drive[k]);
+        drive[k].drive = sweep->drive[k];
+        drive[k].gain_db = sweep->gain_db[k];
+        if (overdrive_init(&drive[k], inter)){
+            return 1;
+        }
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        for (k = 0; k < sweep->lanes; k++){
+            overdrive(&x[b * inter->nframes], &serial[k * n + b * inter->nframes], &drive[k], inter);
+            bench_window(&drive[k]);
+        }
+    }
+    serial_t = bench_time() - begin;
+    overdrive_default(&shared);
+    if (overdrive_init(&shared, inter)){
+        return 1;
+    }
+    overdrive_sweep_init(sweep, inter);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        for (k = 0; k < sweep->lanes; k++){
+            out[k] = &swept[k * n + b * inter->nframes];
+        }
+        overdrive_sweep(&x[b * inter->nframes], out, &shared, sweep, inter);
+        bench_window(&shared);
+    }
+    sweep_t = bench_time() - begin;
+    printf("\n%s\n", title);
+    bench_report("serial", serial_t, blocks);
+    bench_report("sweep", sweep_t, blocks);
+    printf("  speedup %.2fx, max abs difference %g\n", serial_t / sweep_t, bench_error(serial, swept, sweep->lanes * n));
+    for (k = 0; k < sweep->lanes; k++){
+        free(drive[k].window_store);
+    }
+    free(shared.window_store);
+    return 0;
+}
+
+static inline int bench_sweep(float *x, uint32_t blocks){
+    uint32_t n = blocks * inter->nframes;
+    uint32_t k;
+    float *serial = malloc(SWEEP_LANES * n * sizeof(float));
+    float *swept = malloc(SWEEP_LANES * n * sizeof(float));
+    if ((serial == NULL) || (swept == NULL)){
+        fprintf(stderr, "[ERROR] in sweep benchmark memory allocation\n");
+        return 1;
+    }
+    compressor_parameters comp;
+    compressor_sweep_parameters csweep;
+    overdrive_parameters drive;
+    overdrive_sweep_parameters dsweep;
+    compressor_default(&comp);
+    overdrive_default(&drive);
+    //As test_compressor - Shared gain computer
+    compressor_sweep_default(&csweep, &comp);
+    csweep.lanes = 6;
+    for (k = 0; k < 6; k++){
+        csweep.compression_db[k] = 3.0f * (float)k;
+    }
+    if (bench_compressor_sweep(x, blocks, "Compressor (6 variants, compression 0.0dB to 15.0dB)", &csweep, serial, swept)){
+        return 1;
+    }
+    //Independent gain computers across all lanes
+    compressor_sweep_default(&csweep, &comp);
+    for (k = 0; k < SWEEP_LANES; k++){
+        csweep.threshold[k] = -70.0f + 5.0f * (float)k;
+        csweep.attack_t[k] = 0.001f * (float)(k + 1);
+    }
+    if (bench_compressor_sweep(x, blocks, "Compressor (8 variants, threshold -70.0dB to -35.0dB and attack)", &csweep, serial, swept)){
+        return 1;
+    }
+    //As test_overdrive
+    const float drive_level[6] = {0.0f, 0.2f, 0.4f, 0.6f, 0.8f, 1.0f};
+    overdrive_sweep_default(&dsweep, &drive);
+    dsweep.lanes = 6;
+    for (k = 0; k < 6; k++){
+        dsweep.drive[k] = drive_level[k];
+    }
+    if (bench_overdrive_sweep(x, blocks, "Overdrive (6 variants, drive 0.0 to 1.0)", &dsweep, serial, swept)){
+        return 1;
+    }
+    free(serial);
+    free(swept);
+    return 0;
+}
+
+//Effects - Cost of each effect against the period budget
+static inline int bench_effects(float *x, uint32_t blocks){
+    uint32_t b;
+    double begin;
+    float out[inter->nframes];
+    compressor_parameters comp;
+    overdrive_parameters drive;
+    delay_parameters dly;
+    compressor_default(&comp);
+    compressor_init(&comp, inter);
+    overdrive_default(&drive);
+    delay_default(&dly);
+    if (overdrive_init(&drive, inter) || delay_init(&dly, inter)){
+        fprintf(stderr, "[ERROR] in effects benchmark initialisation\n");
+        return 1;
+    }
+    printf("\nEffects\n");
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        compressor(&x[b * inter->nframes], out, &comp, inter);
+    }
+    bench_budget("compressor", bench_time() - begin, blocks);
+    //Quiet Input - Every block below the knee, so only the gain smoothing runs
+    float quiet[inter->nframes];
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        for (uint32_t i = 0; i < inter->nframes; i++){
+            quiet[i] = 0.0005f * x[b * inter->nframes + i];
+        }
+        compressor(quiet, out, &comp, inter);
+    }
+    bench_budget("compressor (quiet, below knee)", bench_time() - begin, blocks);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        overdrive(&x[b * inter->nframes], out, &drive, inter);
+        bench_window(&drive);
+    }
+    bench_budget("overdrive", bench_time() - begin, blocks);
+    //Parameter Ramps - A new target as soon as each ramp settles, so every block ramps
+    uint32_t ramp_blocks = comp.comps_ramp.length / inter->nframes + 1;
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        if ((b % ramp_blocks) == 0){
+            compressor_set(&comp, (b & 1) ? 12.0f : 6.0f, (b & 1) ? -6.0f : 0.0f);
+        }
+        compressor(&x[b * inter->nframes], out, &comp, inter);
+    }
+    bench_budget("compressor (always ramping)", bench_time() - begin, blocks);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        if ((b % ramp_blocks) == 0){
+            overdrive_set(&drive, (b & 1) ? 1.0f : 0.5f, (b & 1) ? -6.0f : 0.0f);
+        }
+        overdrive(&x[b * inter->nframes], out, &drive, inter);
+        bench_window(&drive);
+    }
+    bench_budget("overdrive (always ramping)", bench_time() - begin, blocks);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        delay(&x[b * inter->nframes], out, &dly, inter);
+    }
+    bench_budget("delay", bench_time() - begin, blocks);
+    dly.taps = DELAY_MAX_TAPS;
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        //Keep every tap crossfading - the delay's worst case
+        if ((b % (DELAY_FADE / inter->nframes + 1)) == 0){
+            delay_set_time(&dly, (b & 1) ? 0.25f : 0.3f, 0.0f, inter);
+        }
+        delay(&x[b * inter->nframes], out, &dly, inter);
+    }
+    bench_budget("delay (4 taps, always crossfading)", bench_time() - begin, blocks);
+    octaver_parameters oct;
+    octaver_default(&oct);
+    octaver_init(&oct, inter);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        octaver(&x[b * inter->nframes], out, &oct, inter);
+    }
+    bench_budget("octaver (flip-flop divider)", bench_time() - begin, blocks);
+    oct.quality = 1;
+    octaver_init(&oct, inter);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        octaver(&x[b * inter->nframes], out, &oct, inter);
+    }
+    bench_budget("octaver (2x polyphase divider)", bench_time() - begin, blocks);
+    free(drive.window_store);
+    free(dly.ring);
+    return 0;
+}
+
+//Anomaly Mixes - Shares of samples replaced by each anomaly, and of blocks replaced by a full-scale square wave
+//- Run with denormals flushed, as every real-time thread runs the effects, except where shown
+typedef struct{
+    const char *name;
+    float zero, nan, inf, denormal;
+    float square;
+    uint32_t flush;
+} bench_mix;
+
+static const bench_mix mixes[] = {
+    {"clean", 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1},
+    {"zeros 1%", 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 1},
+    {"silence", 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1},
+    {"NaN 0.1%", 0.0f, 0.001f, 0.0f, 0.0f, 0.0f, 1},
+    {"NaN 10%", 0.0f, 0.1f, 0.0f, 0.0f, 0.0f, 1},
+    {"Inf 0.1%", 0.0f, 0.0f, 0.001f, 0.0f, 0.0f, 1},
+    {"Inf 10%", 0.0f, 0.0f, 0.1f, 0.0f, 0.0f, 1},
+    {"denormals 10%", 0.0f, 0.0f, 0.0f, 0.1f, 0.0f, 1},
+    {"denormals only", 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1},
+    {"denormals, not flushed", 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0},
+    {"square 10% of blocks", 0.0f, 0.0f, 0.0f, 0.0f, 0.1f, 1},
+    {"square every block", 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1},
+    {"everything at 1%", 0.01f, 0.01f, 0.01f, 0.01f, 0.01f, 1},
+};
+
+//Anomaly Signal - x with a mix's anomalies injected, the same for every run of the same mix
+static inline void bench_anomalies(float *x, float *y, uint32_t blocks, const bench_mix *mix){
+    uint32_t n = inter->nframes;
+    uint32_t state = 0x9E3779B9u;
+    for (uint32_t b = 0; b < blocks; b++){
+        //Xorshift - Uniform in [0, 1)
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        int square = ((float)(state >> 8) / 16777216.0f) < mix->square;
+        for (uint32_t i = b * n; i < (b + 1) * n; i++){
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            float u = (float)(state >> 8) / 16777216.0f;
+            float sign = (state & 1) ? -1.0f : 1.0f;
+            y[i] = square ? ((fmodf(BENCH_SQUARE * (float)i / (float)inter->fs, 1.0f) < 0.5f) ? 1.0f : -1.0f) : x[i];
+            if (u < mix->zero){
+                y[i] = 0.0f;
+            }
+            else if ((u -= mix->zero) < mix->nan){
+                y[i] = NAN;
+            }
+            else if ((u -= mix->nan) < mix->inf){
+                y[i] = sign * INFINITY;
+            }
+            else if ((u -= mix->inf) < mix->denormal){
+                y[i] = sign * BENCH_DENORMAL;
+            }
+        }
+    }
+}
+
+//Anomaly Injection - Each effect from its defaults over every mix, each block timed on its own
+//- Slow paths must not cost a period: the worst block is reported against the budget, with the blocks over it.
+//  A preempted block shows up here too, so a single late block on a loaded machine is not the effect's
+//- Outputs must stay finite whatever the input, so anything else fails the benchmark
+static inline int bench_anomaly(float *x, uint32_t blocks){
+    const char *names[4] = {"compressor", "overdrive", "delay", "octaver"};
+    uint32_t n = inter->nframes;
+    uint32_t b, e, m, i;
+    double budget = (double)n / (double)inter->fs;
+    float out[n];
+    float *y = malloc((size_t)blocks * n * sizeof(float));
+    compressor_parameters comp;
+    overdrive_parameters drive;
+    delay_parameters dly;
+    octaver_parameters oct;
+    int failed = 0;
+    if (y == NULL){
+        fprintf(stderr, "[ERROR] in anomaly benchmark memory allocation\n");
+        return 1;
+    }
+    printf("\nAnomaly Injection (each block timed, against the %.0fus budget)\n", 1e6 * budget);
+    for (e = 0; e < 4; e++){
+        printf("  %s\n", names[e]);
+        for (m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++){
+            uint32_t late = 0, faults = 0, nonfinite = 0;
+            double begin, block, total = 0.0, worst = 0.0;
+            bench_anomalies(x, y, blocks, &mixes[m]);
+            compressor_default(&comp);
+            compressor_init(&comp, inter);
+            overdrive_default(&drive);
+            delay_default(&dly);
+            octaver_default(&oct);
+            octaver_init(&oct, inter);
+            if (overdrive_init(&drive, inter) || delay_init(&dly, inter)){
+                fprintf(stderr, "[ERROR] in anomaly benchmark initialisation\n");
+                return 1;
+            }
+            uint64_t mode = mixes[m].flush ? sample_flush_denormals() : 0;
+            for (b = 0; b < blocks; b++){
+                float *in = &y[b * n];
+                int err = 0;
+                begin = bench_time();
+                switch (e){
+                    case 0:
+                        err = compressor(in, out, &comp, inter);
+                        break;
+                    case 1:
+                        err = overdrive(in, out, &drive, inter);
+                        bench_window(&drive);
+                        break;
+                    case 2:
+                        err = delay(in, out, &dly, inter);
+                        break;
+                    default:
+                        err = octaver(in, out, &oct, inter);
+                        break;
+                }
+                block = bench_time() - begin;
+                total += block;
+                worst = (block > worst) ? block : worst;
+                late += (block > budget);
+                faults += (err != 0);
+                for (i = 0; i < n; i++){
+                    nonfinite += !isfinite(out[i]);
+                }
+            }
+            if (mixes[m].flush){
+                sample_restore_denormals(mode);
+            }
+            printf("    %-22s %8.1fx real-time  worst %8.1fus %6.2f%%  %u late  %u fault(s)  %u non-finite\n",
+                   mixes[m].name, ((double)blocks * budget) / total, 1e6 * worst, 100.0 * worst / budget, late, faults, nonfinite);
+            failed |= (nonfinite > 0);
+            free(drive.window_store);
+            free(dly.ring);
+        }
+    }
+    free(y);
+    if (failed){
+        fprintf(stderr, "[ERROR] Non-finite samples reached an effect's output\n");
+        return 1;
+    }
+    return 0;
+}
+
+//State Snapshots - Fork from the midpoint of a render and check the continuation is exact
+//- Live changes shortly before the fork put the ramps and the delay's crossfades mid-way when it is taken
+static inline int bench_state(float *x, uint32_t blocks){
+    uint32_t n = blocks * inter->nframes;
+    uint32_t half = blocks / 2;
+    uint32_t b, r, repeats = 10000;
+    float *a = malloc(n * sizeof(float));
+    float *c = malloc(n * sizeof(float));
+    compressor_parameters comp;
+    overdrive_parameters drive;
+    octaver_parameters oct;
+    delay_parameters dly;
+    compressor_default(&comp);
+    compressor_init(&comp, inter);
+    overdrive_default(&drive);
+    octaver_default(&oct);
+    //2x Divider, so the polyphase filter histories are in the state too
+    oct.quality = 1;
+    octaver_init(&oct, inter);
+    delay_default(&dly);
+    if ((a == NULL) || (c == NULL) || overdrive_init(&drive, inter) || delay_init(&dly, inter)){
+        fprintf(stderr, "[ERROR] in state benchmark initialisation\n");
+        return 1;
+    }
+    void *comp_state = malloc(compressor_state_size(&comp));
+    void *drive_state = malloc(overdrive_state_size(&drive));
+    void *oct_state = malloc(octaver_state_size(&oct));
+    void *dly_state = malloc(delay_state_size(&dly));
+    if ((comp_state == NULL) || (drive_state == NULL) || (oct_state == NULL) || (dly_state == NULL)){
+        fprintf(stderr, "[ERROR] in state snapshot memory allocation\n");
+        return 1;
+    }
+    //Render compressor -> overdrive -> octaver -> delay, forking at the midpoint
+    for (b = 0; b < blocks; b++){
+        if (b == (half - 8)){
+            delay_set_time(&dly, 0.25f, 0.0f, inter);
+        }
+        else if (b == (half - 4)){
+            compressor_set(&comp, 12.0f, -3.0f);
+            overdrive_set(&drive, 0.9f, 2.0f);
+            //Queued behind the crossfade still running
+            delay_set_time(&dly, 0.5f, 0.0f, inter);
+        }
+        else if (b == half){
+            compressor_snapshot(&comp, comp_state);
+            overdrive_snapshot(&drive, drive_state);
+            octaver_snapshot(&oct, oct_state);
+            delay_snapshot(&dly, dly_state);
+        }
+        compressor(&x[b * inter->nframes], &a[b * inter->nframes], &comp, inter);
+        overdrive(&a[b * inter->nframes], &a[b * inter->nframes], &drive, inter);
+        bench_window(&drive);
+        octaver(&a[b * inter->nframes], &a[b * inter->nframes], &oct, inter);
+        delay(&a[b * inter->nframes], &a[b * inter->nframes], &dly, inter);
+    }
+    //Resume from the fork
+    if (compressor_restore(&comp, comp_state) || overdrive_restore(&drive, drive_state) || octaver_restore(&oct, oct_state) || delay_restore(&dly, dly_state)){
+        return 1;
+    }
+    for (b = half; b < blocks; b++){
+        compressor(&x[b * inter->nframes], &c[b * inter->nframes], &comp, inter);
+        overdrive(&c[b * inter->nframes], &c[b * inter->nframes], &drive, inter);
+        bench_window(&drive);
+        octaver(&c[b * inter->nframes], &c[b * inter->nframes], &oct, inter);
+        delay(&c[b * inter->nframes], &c[b * inter->nframes], &dly, inter);
+    }
+    float err = bench_error(&a[half * inter->nframes], &c[half * inter->nframes], n - half * inter->nframes);
+    //Snapshot and Restore Cost - The delay copies its ring, so is timed over fewer repeats
+    double begin = bench_time();
+    for (r = 0; r < repeats; r++){
+        compressor_snapshot(&comp, comp_state);
+        compressor_restore(&comp, comp_state);
+    }
+    double comp_t = (bench_time() - begin) / (double)repeats;
+    begin = bench_time();
+    for (r = 0; r < repeats; r++){
+        overdrive_snapshot(&drive, drive_state);
+        overdrive_restore(&drive, drive_state);
+    }
+    double drive_t = (bench_time() - begin) / (double)repeats;
+    begin = bench_time();
+    for (r = 0; r < repeats; r++){
+        octaver_snapshot(&oct, oct_state);
+        octaver_restore(&oct, oct_state);
+    }
+    double oct_t = (bench_time() - begin) / (double)repeats;
+    begin = bench_time();
+    for (r = 0; r < (repeats / 100); r++){
+        delay_snapshot(&dly, dly_state);
+        delay_restore(&dly, dly_state);
+    }
+    double dly_t = (bench_time() - begin) / (double)(repeats / 100);
+    printf("\nState Snapshots (compressor -> overdrive -> octaver -> delay), snapshot + restore\n");
+    printf("  compressor %10zu bytes %12.1f ns\n", compressor_state_size(&comp), 1e9 * comp_t);
+    printf("  overdrive  %10zu bytes %12.1f ns\n", overdrive_state_size(&drive), 1e9 * drive_t);
+    printf("  octaver    %10zu bytes %12.1f ns\n", octaver_state_size(&oct), 1e9 * oct_t);
+    printf("  delay      %10zu bytes %12.1f ns\n", delay_state_size(&dly), 1e9 * dly_t);
+    printf("  - delay copies %zu bytes, the ring in use at %uHz\n", sizeof(delay_state) + (size_t)(dly.mask + 1) * sizeof(float), inter->fs);
+    printf("  max abs difference after restore %g\n", err);
+    free(comp_state);
+    free(drive_state);
+    free(oct_state);
+    free(dly_state);
+    free(drive.window_store);
+    free(dly.ring);
+    free(a);
+    free(c);
+    return (err != 0.0f);
+}
+
+//Effect Graph - A compiled serial chain must match direct calls exactly, then a split-band rig
+static inline int bench_graph(float *x, uint32_t blocks){
+    uint32_t b, i, n = inter->nframes;
+    double begin;
+    float *direct = malloc((size_t)blocks * n * sizeof(float));
+    float *graphed = malloc((size_t)blocks * n * sizeof(float));
+    float stage[n];
+    compressor_parameters comp[2];
+    overdrive_parameters drive[2];
+    graph_parameters serial, split;
+    if ((direct == NULL) || (graphed == NULL)){
+        fprintf(stderr, "[ERROR] in graph benchmark memory allocation\n");
+        return 1;
+    }
+    for (i = 0; i < 2; i++){
+        compressor_default(&comp[i]);
+        compressor_init(&comp[i], inter);
+        overdrive_default(&drive[i]);
+        if (overdrive_init(&drive[i], inter)){
+            fprintf(stderr, "[ERROR] in graph benchmark initialisation\n");
+            return 1;
+        }
+    }
+    printf("\nEffect Graph (compressor -> overdrive)\n");
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        compressor(&x[b * n], stage, &comp[0], inter);
+        overdrive(stage, &direct[b * n], &drive[0], inter);
+        bench_window(&drive[0]);
+    }
+    bench_report("direct calls", bench_time() - begin, blocks);
+    graph_default(&serial);
+    if (graph_add(&serial, "comp", GRAPH_COMPRESSOR, "in", &comp[1]) ||
+        graph_add(&serial, "dirt", GRAPH_OVERDRIVE, "comp", &drive[1]) ||
+        graph_compile(&serial, inter)){
+        return 1;
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        graph_process(&x[b * n], &graphed[b * n], &serial, inter);
+    }
+    bench_report("compiled graph", bench_time() - begin, blocks);
+    float diff = bench_error(direct, graphed, blocks * n);
+    printf("  max abs difference %g, %u scratch buffer(s)\n", diff, serial.nbuffers - 2);
+    //Split-Band Rig - As res/graphs/split_drive.graph
+    printf("\nEffect Graph (split-band overdrive, 5 nodes)\n");
+    compressor_default(&comp[0]);
+    compressor_init(&comp[0], inter);
+    free(drive[0].window_store);
+    overdrive_default(&drive[0]);
+    drive[0].drive = 0.8f;
+    graph_default(&split);
+    if (overdrive_init(&drive[0], inter) ||
+        graph_add(&split, "comp", GRAPH_COMPRESSOR, "in", &comp[0]) ||
+        graph_add(&split, "low", GRAPH_LOWPASS, "comp", NULL) ||
+        graph_add(&split, "high", GRAPH_HIGHPASS, "comp", NULL) ||
+        graph_add(&split, "dirt", GRAPH_OVERDRIVE, "high", &drive[0]) ||
+        graph_add(&split, "blend", GRAPH_MIX, "low,dirt", NULL) ||
+        graph_compile(&split, inter)){
+        return 1;
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        graph_process(&x[b * n], &graphed[b * n], &split, inter);
+    }
+    bench_budget("compiled graph", bench_time() - begin, blocks);
+    printf("  %u scratch buffer(s) for 4 intermediate values\n", split.nbuffers - 2);
+    graph_free(&serial);
+    graph_free(&split);
+    for (i = 0; i < 2; i++){
+        free(drive[i].window_store);
+    }
+    free(direct);
+    free(graphed);
+    if (diff != 0.0f){
+        fprintf(stderr, "[ERROR] Compiled graph differs from direct calls\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Worker Pool - Independent rigs, one after another and as one pool run per block as rripple_host makes them,
+//from identical initial state. Every rig's output must match exactly, whichever thread ran it
+typedef struct{
+    graph_parameters *graph;
+    float *in, *out;
+} bench_rig;
+
+static void bench_rig_process(void *arg){
+    bench_rig *rig = (bench_rig*)arg;
+    graph_process(rig->in, rig->out, rig->graph, inter);
+}
+
+static inline int bench_pool(float *x, uint32_t blocks){
+    uint32_t b, r, i, n = inter->nframes;
+    double begin, serial_t = 0.0, pooled_t = 0.0;
+    float diff = 0.0f;
+    uint32_t threads;
+    compressor_parameters comp[2][BENCH_RIGS];
+    overdrive_parameters drive[2][BENCH_RIGS];
+    graph_parameters *graphs = malloc(2 * BENCH_RIGS * sizeof(graph_parameters));
+    float *outs = malloc(2 * BENCH_RIGS * n * sizeof(float));
+    bench_rig rigs[BENCH_RIGS];
+    pool_task tasks[BENCH_RIGS];
+    static pool_parameters pool;
+    if ((graphs == NULL) || (outs == NULL)){
+        fprintf(stderr, "[ERROR] in pool benchmark memory allocation\n");
+        return 1;
+    }
+    //Rigs - compressor -> overdrive, each with its own drive, twice over
+    for (i = 0; i < 2; i++){
+        for (r = 0; r < BENCH_RIGS; r++){
+            graph_parameters *graph = &graphs[i * BENCH_RIGS + r];
+            compressor_default(&comp[i][r]);
+            compressor_init(&comp[i][r], inter);
+            overdrive_default(&drive[i][r]);
+            drive[i][r].drive = 0.2f + 0.1f * (float)r;
+            graph_default(graph);
+            if (overdrive_init(&drive[i][r], inter) ||
+                graph_add(graph, "comp", GRAPH_COMPRESSOR, "in", &comp[i][r]) ||
+                graph_add(graph, "dirt", GRAPH_OVERDRIVE, "comp", &drive[i][r]) ||
+                graph_compile(graph, inter)){
+                fprintf(stderr, "[ERROR] in pool benchmark initialisation\n");
+                return 1;
+            }
+        }
+    }
+    for (r = 0; r < BENCH_RIGS; r++){
+        rigs[r].graph = &graphs[BENCH_RIGS + r];
+        rigs[r].out = &outs[(BENCH_RIGS + r) * n];
+        tasks[r].function = bench_rig_process;
+        tasks[r].arg = &rigs[r];
+    }
+    pool_default(&pool);
+    if (pool_start(&pool)){
+        return 1;
+    }
+    printf("\nWorker Pool (%u compressor -> overdrive rigs, %u worker(s) besides the caller)\n", BENCH_RIGS, pool.started);
+    for (b = 0; b < blocks; b++){
+        begin = bench_time();
+        for (r = 0; r < BENCH_RIGS; r++){
+            graph_process(&x[b * n], &outs[r * n], &graphs[r], inter);
+        }
+        serial_t += bench_time() - begin;
+        for (r = 0; r < BENCH_RIGS; r++){
+            rigs[r].in = &x[b * n];
+        }
+        begin = bench_time();
+        pool_run(&pool, tasks, BENCH_RIGS);
+        pooled_t += bench_time() - begin;
+        float err = bench_error(outs, &outs[BENCH_RIGS * n], BENCH_RIGS * n);
+        diff = (err > diff) ? err : diff;
+    }
+    threads = pool.started + 1;
+    pool_stop(&pool);
+    bench_budget("rigs one after another", serial_t, blocks);
+    bench_budget("rigs across the pool", pooled_t, blocks);
+    printf("  speedup %.2fx on %u thread(s), max abs difference %g\n", serial_t / pooled_t, threads, diff);
+    for (i = 0; i < 2 * BENCH_RIGS; i++){
+        graph_free(&graphs[i]);
+        free(drive[i / BENCH_RIGS][i % BENCH_RIGS].window_store);
+    }
+    free(graphs);
+    free(outs);
+    if (diff != 0.0f){
+        fprintf(stderr, "[ERROR] Pooled rigs differ from the same rigs run in turn\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Hardware Counter for this Thread - Returns -1 where the kernel or a virtual machine does not expose it
+static inline int bench_counter(uint32_t type, uint64_t config){
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static inline uint64_t bench_count(int fd){
+    uint64_t count = 0;
+    if ((fd < 0) || (read(fd, &count, sizeof(count)) != sizeof(count))){
+        return 0;
+    }
+    return count;
+}
+
+//Effect State Layout - Independent compressor -> overdrive instances, each allocated as hosts allocate them,
+//run in turn on every block as one host runs many channels. Once the instances outgrow the caches, each block
+//misses on whatever state it reads, so the lines touched per block set the cost
+static inline int bench_layout(float *x, uint32_t blocks){
+    const uint32_t counts[4] = {1, 16, 64, BENCH_INSTANCES};
+    uint32_t b, c, k, n = inter->nframes;
+    static compressor_parameters *comp[BENCH_INSTANCES];
+    static overdrive_parameters *drive[BENCH_INSTANCES];
+    float y[n];
+    //Counters - L1 data read misses, and misses in the last level cache
+    int l1 = bench_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    int llc = bench_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    printf("\nEffect State Layout (compressor -> overdrive instances, run in turn each block)\n");
+    printf("  compressor_parameters %zu bytes, hot state %zu bytes from line 1, ramps from line %zu\n",
+           sizeof(compressor_parameters), offsetof(compressor_parameters, lin) + sizeof(float), offsetof(compressor_parameters, comps_ramp) / SAMPLE_LINE + 1);
+    printf("  overdrive_parameters  %zu bytes, hot state %zu bytes from line 1, ramps from line %zu\n",
+           sizeof(overdrive_parameters), offsetof(overdrive_parameters, norm_factor) + sizeof(float), offsetof(overdrive_parameters, drive_ramp) / SAMPLE_LINE + 1);
+    if ((l1 < 0) || (llc < 0)){
+        printf("  Cache-miss counters unavailable (perf_event_open: %s) - Timing only\n", strerror(errno));
+    }
+    for (k = 0; k < BENCH_INSTANCES; k++){
+        comp[k] = sample_alloc(sizeof(compressor_parameters));
+        drive[k] = sample_alloc(sizeof(overdrive_parameters));
+        if ((comp[k] == NULL) || (drive[k] == NULL)){
+            fprintf(stderr, "[ERROR] in layout benchmark memory allocation\n");
+            return 1;
+        }
+        compressor_default(comp[k]);
+        compressor_init(comp[k], inter);
+        overdrive_default(drive[k]);
+        drive[k]->drive = 0.5f + 0.001f * (float)k;
+        if (overdrive_init(drive[k], inter)){
+            return 1;
+        }
+    }
+    for (c = 0; c < 4; c++){
+        //Equal Work at each count - Instance blocks as 16 instances over the whole signal
+        uint32_t count = counts[c];
+        uint32_t nblocks = (count > 16) ? (blocks * 16) / count : blocks;
+        uint64_t l1_misses = 0, llc_misses = 0;
+        double begin, elapsed = 0.0;
+        char name[64];
+        for (b = 0; b < nblocks; b++){
+            if (l1 >= 0){
+                ioctl(l1, PERF_EVENT_IOC_RESET, 0);
+                ioctl(l1, PERF_EVENT_IOC_ENABLE, 0);
+            }
+            if (llc >= 0){
+                ioctl(llc, PERF_EVENT_IOC_RESET, 0);
+                ioctl(llc, PERF_EVENT_IOC_ENABLE, 0);
+            }
+            begin = bench_time();
+            for (k = 0; k < count; k++){
+                compressor(&x[b * n], y, comp[k], inter);
+                overdrive(y, y, drive[k], inter);
+                bench_window(drive[k]);
+            }
+            elapsed += bench_time() - begin;
+            if (l1 >= 0){
+                ioctl(l1, PERF_EVENT_IOC_DISABLE, 0);
+            }
+            if (llc >= 0){
+                ioctl(llc, PERF_EVENT_IOC_DISABLE, 0);
+            }
+            l1_misses += bench_count(l1);
+            llc_misses += bench_count(llc);
+        }
+        double instance_blocks = (double)nblocks * (double)count;
+        snprintf(name, sizeof(name), "%u instance(s), per instance", count);
+        printf("  %-36s %10.1f ns/block", name, 1e9 * elapsed / instance_blocks);
+        if ((l1 >= 0) && (llc >= 0)){
+            printf(" %8.2f L1 %8.2f LLC misses/block", (double)l1_misses / instance_blocks, (double)llc_misses / instance_blocks);
+        }
+        printf("\n");
+    }
+    for (k = 0; k < BENCH_INSTANCES; k++){
+        free(drive[k]->window_store);
+        free(comp[k]);
+        free(drive[k]);
+    }
+    if (l1 >= 0){
+        close(l1);
+    }
+    if (llc >= 0){
+        close(llc);
+    }
+    return 0;
+}
+
+//Sub-Blocks - A graph splitting each period into 16 frame sub-blocks must match direct calls made at a
+//16 frame period exactly, then the cost against whole periods
+static inline int bench_subblock(float *x, uint32_t blocks){
+    uint32_t b, i, n = inter->nframes, len = INTERFACE_MIN_NFRAMES;
+    double begin, whole;
+    float *direct = malloc((size_t)blocks * n * sizeof(float));
+    float *graphed = malloc((size_t)blocks * n * sizeof(float));
+    float stage[INTERFACE_MIN_NFRAMES];
+    compressor_parameters comp[3];
+    overdrive_parameters drive[3];
+    graph_parameters period, split;
+    interface_parameters sub = *inter;
+    printf("\nSub-Blocks (compressor -> overdrive, %u frame sub-blocks)\n", len);
+    if ((n <= len) || (n % len != 0)){
+        printf("  Period of %u frames does not split - Run with --nframes above %u\n", n, len);
+        free(direct);
+        free(graphed);
+        return 0;
+    }
+    if ((direct == NULL) || (graphed == NULL)){
+        fprintf(stderr, "[ERROR] in subblock benchmark memory allocation\n");
+        return 1;
+    }
+    sub.nframes = len;
+    for (i = 0; i < 3; i++){
+        compressor_default(&comp[i]);
+        compressor_init(&comp[i], (i == 0) ? &sub : inter);
+        overdrive_default(&drive[i]);
+        if (overdrive_init(&drive[i], (i == 0) ? &sub : inter)){
+            fprintf(stderr, "[ERROR] in subblock benchmark initialisation\n");
+            return 1;
+        }
+    }
+    //Reference - Direct calls at a 16 frame period
+    for (b = 0; b < blocks * (n / len); b++){
+        compressor(&x[b * len], stage, &comp[0], &sub);
+        overdrive(stage, &direct[b * len], &drive[0], &sub);
+        bench_window(&drive[0]);
+    }
+    graph_default(&period);
+    graph_default(&split);
+    split.subblock = len;
+    if (graph_add(&period, "comp", GRAPH_COMPRESSOR, "in", &comp[1]) ||
+        graph_add(&period, "dirt", GRAPH_OVERDRIVE, "comp", &drive[1]) ||
+        graph_compile(&period, inter) ||
+        graph_add(&split, "comp", GRAPH_COMPRESSOR, "in", &comp[2]) ||
+        graph_add(&split, "dirt", GRAPH_OVERDRIVE, "comp", &drive[2]) ||
+        graph_compile(&split, inter)){
+        return 1;
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        graph_process(&x[b * n], &graphed[b * n], &period, inter);
+    }
+    whole = bench_time() - begin;
+    bench_budget("whole periods", whole, blocks);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        graph_process(&x[b * n], &graphed[b * n], &split, inter);
+    }
+    double elapsed = bench_time() - begin;
+    bench_budget("sub-blocks", elapsed, blocks);
+    float diff = bench_error(direct, graphed, blocks * n);
+    printf("  %.2fx the cost of whole periods, max abs difference %g against a %u frame period\n", elapsed / whole, diff, len);
+    graph_free(&period);
+    graph_free(&split);
+    for (i = 0; i < 3; i++){
+        free(drive[i].window_store);
+    }
+    free(direct);
+    free(graphed);
+    if (diff != 0.0f){
+        fprintf(stderr, "[ERROR] Sub-blocks differ from direct calls at the sub-block period\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Control-Rate Compressor - Cost and error of each interval against the full-rate compressor
+static inline int bench_control(float *x, uint32_t blocks){
+    const uint32_t rates[4] = {1, 4, 8, 16};
+    uint32_t b, r, n = inter->nframes;
+    double begin, elapsed, full = 0.0;
+    char name[64];
+    float *reference = malloc((size_t)blocks * n * sizeof(float));
+    float *rendered = malloc((size_t)blocks * n * sizeof(float));
+    compressor_parameters comp;
+    if ((reference == NULL) || (rendered == NULL)){
+        fprintf(stderr, "[ERROR] in control benchmark memory allocation\n");
+        return 1;
+    }
+    printf("\nCompressor Control Rate\n");
+    float worst = 0.0f;
+    for (r = 0; r < 4; r++){
+        compressor_default(&comp);
+        comp.control_rate = rates[r];
+        compressor_init(&comp, inter);
+        float *y = (r == 0) ? reference : rendered;
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            compressor(&x[b * n], &y[b * n], &comp, inter);
+        }
+        elapsed = bench_time() - begin;
+        if (r == 0){
+            full = elapsed;
+            bench_budget("every sample", elapsed, blocks);
+            continue;
+        }
+        snprintf(name, sizeof(name), "every %u samples", rates[r]);
+        bench_budget(name, elapsed, blocks);
+        //Error against full rate - Relative to the full-rate output's peak
+        float diff = bench_error(reference, rendered, blocks * n);
+        float peak = 0.0f;
+        for (uint32_t i = 0; i < blocks * n; i++){
+            peak = (fabsf(reference[i]) > peak) ? fabsf(reference[i]) : peak;
+        }
+        printf("  %.2fx less CPU, max abs error %g (%.1f dB below peak)\n", full / elapsed, diff, 20.0f * log10f(peak / diff));
+        if (diff > worst){
+            worst = diff;
+        }
+    }
+    free(reference);
+    free(rendered);
+    //Anything near full scale is an interpolation fault, not control-rate error
+    if (worst > 0.1f){
+        fprintf(stderr, "[ERROR] Control-rate compressor strays from full rate\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Per-Sample Compressor - As compressor() ran a mixed block before it was staged, the reference for bench_stages
+static inline void scalar_compress(float *in, float *out, compressor_parameters *comp, uint32_t n){
+    float abs, lin;
+    for (uint32_t i = 0; i < n; i++){
+        abs = fabsf(in[i]);
+        if ((abs == 0.0f) || (isnan(abs)) || (isinf(abs))){
+            out[i] = 0.0f;
+            compressor_smoothing(comp, 0.0f);
+        }
+        else{
+            lin = powf(10.0f, 0.05f * compressor_smoothing(comp, compressor_computer(comp, 20.0f * log10f(abs))));
+            out[i] = (comp->comps * in[i] * lin) + in[i];
+            out[i] *= comp->gain;
+        }
+    }
+}
+
+//Compressor Stages - Every block through the staged mixed-block path, one stage at a time over the whole
+//signal, against the per-sample loop it replaced and compressor() (which takes a cheaper path where it can).
+//Quickest of 8 passes each, and all three must match exactly
+static inline int bench_stages(float *x, uint32_t blocks){
+    const char *names[6] = {"per-sample loop", "curve (level, gain computer)", "smoothing (recurrence)",
+                            "apply (linear gain, mix)", "staged total", "compressor()"};
+    uint32_t b, k, pass, n = inter->nframes;
+    double begin, best[6] = {1e30, 1e30, 1e30, 1e30, 1e30, 1e30};
+    float *y[3], *g = malloc((size_t)blocks * n * sizeof(float));
+    compressor_parameters comp;
+    for (k = 0; k < 3; k++){
+        y[k] = malloc((size_t)blocks * n * sizeof(float));
+        if ((y[k] == NULL) || (g == NULL)){
+            fprintf(stderr, "[ERROR] in stages benchmark memory allocation\n");
+            return 1;
+        }
+    }
+    printf("\nCompressor Stages (every block as a mixed block)\n");
+    for (pass = 0; pass < 8; pass++){
+        double t[6];
+        //Per-Sample Loop
+        compressor_default(&comp);
+        compressor_init(&comp, inter);
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            scalar_compress(&x[b * n], &y[0][b * n], &comp, n);
+        }
+        t[0] = bench_time() - begin;
+        //Each Stage over Every Block - Gains carried between stages in g
+        compressor_default(&comp);
+        compressor_init(&comp, inter);
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            compressor_stage_curve(&comp, &x[b * n], &g[b * n], n);
+        }
+        t[1] = bench_time() - begin;
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            compressor_stage_smooth(&comp, &g[b * n], n);
+        }
+        t[2] = bench_time() - begin;
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            compressor_stage_apply(&x[b * n], &y[1][b * n], &g[b * n], n, &comp.comps, &comp.gain, 0);
+        }
+        t[3] = bench_time() - begin;
+        //Stages in Turn on each Block, as compressor() runs them
+        compressor_default(&comp);
+        compressor_init(&comp, inter);
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            compressor_stage_curve(&comp, &x[b * n], &g[b * n], n);
+            compressor_stage_smooth(&comp, &g[b * n], n);
+            compressor_stage_apply(&x[b * n], &y[1][b * n], &g[b * n], n, &comp.comps, &comp.gain, 0);
+        }
+        t[4] = bench_time() - begin;
+        compressor_default(&comp);
+        compressor_init(&comp, inter);
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            compressor(&x[b * n], &y[2][b * n], &comp, inter);
+        }
+        t[5] = bench_time() - begin;
+        for (k = 0; k < 6; k++){
+            best[k] = (t[k] < best[k]) ? t[k] : best[k];
+        }
+    }
+    for (k = 0; k < 6; k++){
+        bench_report(names[k], best[k], blocks);
+    }
+    float diff[2] = {bench_error(y[0], y[1], blocks * n), bench_error(y[0], y[2], blocks * n)};
+    printf("  staged %.2fx faster than per-sample, max abs difference %g (staged), %g (compressor())\n",
+           best[0] / best[4], diff[0], diff[1]);
+    for (k = 0; k < 3; k++){
+        free(y[k]);
+    }
+    free(g);
+    if ((diff[0] != 0.0f) || (diff[1] != 0.0f)){
+        fprintf(stderr, "[ERROR] Staged compressor differs from the per-sample loop\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Scalar Peak Kernels - As overdrive() ran them before include/peak.h, the reference for bench_peak
+static inline float scalar_max_abs(const float *x, uint32_t n){
+    float local_peak = 0.0f;
+    float abs;
+    for (uint32_t i = 0; i < n; i++){
+        abs = fabsf(x[i]);
+        if (abs > local_peak){
+            local_peak = abs;
+        }
+    }
+    return local_peak;
+}
+
+static inline void scalar_prefix_max(const float *x, uint32_t n, float prev, float *out){
+    float abs;
+    for (uint32_t i = 0; i < n; i++){
+        abs = fabsf(x[i]);
+        prev = (abs > prev) ? abs : prev;
+        out[i] = prev;
+    }
+}
+
+static inline void scalar_curve_block(const float *in, float *out, float env, float norm_factor, float gain, uint32_t n){
+    float norm, abs;
+    for (uint32_t i = 0; i < n; i++){
+        norm = in[i] / env;
+        abs = fabsf(norm);
+        if ((abs == 0.0f) || (isnan(abs)) || (isinf(abs))){
+            out[i] = 0.0f;
+            continue;
+        }
+        if (abs <= OVERDRIVE_THRESHOLD){
+            out[i] = 2.0f * in[i];
+        }
+        else if (abs <= (2.0f * OVERDRIVE_THRESHOLD)){
+            out[i] = (norm > 0.0f) ? env * (3.0f - powf((2.0f - norm * 3.0f), 2.0f)) / 3.0f
+                                   : env * (-(3.0f - powf((2.0f - (abs * 3.0f)), 2.0f)) / 3.0f);
+        }
+        else{
+            out[i] = (norm > 0.0f) ? env : -env;
+        }
+        out[i] /= norm_factor;
+        out[i] *= gain;
+    }
+}
+
+//Overdrive Peak Kernels - Scalar loops against include/peak.h and the reciprocal-multiply characteristic,
+//alternating and taking the quickest pass of each. Peak kernels must match exactly, the characteristic to
+//within 4ulp of each block's envelope
+static inline int bench_peak(float *x, uint32_t blocks){
+    const char *names[3] = {"block peak", "running peak", "normalise"};
+    uint32_t b, k, pass, n = inter->nframes;
+    char name[64];
+    double begin, elapsed, best[3][2] = {{1e30, 1e30}, {1e30, 1e30}, {1e30, 1e30}};
+    float diff[3] = {0.0f, 0.0f, 0.0f};
+    float *ref = malloc((size_t)blocks * n * sizeof(float));
+    float *vec = malloc((size_t)blocks * n * sizeof(float));
+    float *env = malloc((size_t)blocks * sizeof(float));
+    float *peaks[2] = {malloc((size_t)blocks * sizeof(float)), malloc((size_t)blocks * sizeof(float))};
+    overdrive_parameters drive;
+    if ((ref == NULL) || (vec == NULL) || (env == NULL) || (peaks[0] == NULL) || (peaks[1] == NULL)){
+        fprintf(stderr, "[ERROR] in peak benchmark memory allocation\n");
+        return 1;
+    }
+    overdrive_default(&drive);
+    if (overdrive_init(&drive, inter)){
+        fprintf(stderr, "[ERROR] in peak benchmark initialisation\n");
+        return 1;
+    }
+    const float k_gain = drive.gain / drive.norm_factor;
+    printf("\nOverdrive Peak Kernels (scalar against %u-lane vectors)\n", PEAK_LANES);
+    for (pass = 0; pass < 16; pass++){
+        uint32_t v = pass & 1;
+        //Block Peak
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            peaks[v][b] = v ? peak_max_abs(&x[b * n], n) : scalar_max_abs(&x[b * n], n);
+        }
+        elapsed = bench_time() - begin;
+        best[0][v] = (elapsed < best[0][v]) ? elapsed : best[0][v];
+        //Running Peak - Carried across blocks, as it would be from the window peak
+        float *y = v ? vec : ref;
+        float prev = 0.0f;
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            if (v){
+                peak_prefix_max(&x[b * n], n, prev, &y[b * n]);
+            }
+            else{
+                scalar_prefix_max(&x[b * n], n, prev, &y[b * n]);
+            }
+            prev = y[b * n + n - 1];
+        }
+        elapsed = bench_time() - begin;
+        best[1][v] = (elapsed < best[1][v]) ? elapsed : best[1][v];
+        if (v){
+            diff[1] = bench_error(ref, vec, blocks * n);
+        }
+    }
+    diff[0] = bench_error(peaks[0], peaks[1], blocks);
+    //Normalise - Each block against a constant envelope, its own peak (silent blocks given a small one)
+    for (b = 0; b < blocks; b++){
+        env[b] = ((peaks[0][b] > 0.01f) ? peaks[0][b] : 0.01f) * drive.drive_coeff;
+    }
+    for (pass = 0; pass < 16; pass++){
+        uint32_t v = pass & 1;
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            if (v){
+                overdrive_curve_block(&x[b * n], &vec[b * n], env[b], k_gain, n);
+            }
+            else{
+                scalar_curve_block(&x[b * n], &ref[b * n], env[b], drive.norm_factor, drive.gain, n);
+            }
+        }
+        elapsed = bench_time() - begin;
+        best[2][v] = (elapsed < best[2][v]) ? elapsed : best[2][v];
+    }
+    //Error in ulp of the envelope - Worst over every sample
+    for (b = 0; b < blocks; b++){
+        float e = bench_error(&ref[b * n], &vec[b * n], n) / (env[b] * k_gain * FLT_EPSILON);
+        diff[2] = (e > diff[2]) ? e : diff[2];
+    }
+    for (k = 0; k < 3; k++){
+        snprintf(name, sizeof(name), "%s, scalar", names[k]);
+        bench_report(name, best[k][0], blocks);
+        snprintf(name, sizeof(name), "%s, vector", names[k]);
+        bench_report(name, best[k][1], blocks);
+        if (k < 2){
+            printf("  %.2fx faster, max abs difference %g\n", best[k][0] / best[k][1], diff[k]);
+        }
+        else{
+            printf("  %.2fx faster, max difference %.2fulp of the envelope\n", best[k][0] / best[k][1], diff[k]);
+        }
+    }
+    free(ref);
+    free(vec);
+    free(env);
+    free(peaks[0]);
+    free(peaks[1]);
+    free(drive.window_store);
+    if ((diff[0] != 0.0f) || (diff[1] != 0.0f) || (diff[2] > 4.0f)){
+        fprintf(stderr, "[ERROR] Peak kernels differ from the scalar loops\n");
+        return 1;
+    }
+    return 0;
+}
+
+//MIDI Control - A period without events must match graph_process() exactly, and a change sent for frame k
+//must leave frames before k untouched and change frame k itself. Events that change nothing must not split the
+//period. Then the cost of splitting at 1 and 4 events
+static inline int bench_midi_graph(graph_parameters *graph, compressor_parameters *comp, midi_parameters *midi){
+    compressor_default(comp);
+    compressor_init(comp, inter);
+    graph_default(graph);
+    midi_default(midi);
+    return graph_add(graph, "comp", GRAPH_COMPRESSOR, "in", comp) || graph_compile(graph, inter) ||
+           midi_map_cc(midi, graph, 7, "comp.gain_db", -12.0f, 0.0f);
+}
+
+static inline int bench_midi(float *x, uint32_t blocks){
+    static const uint8_t cc_low[3] = {0xB0, 7, 0}, cc_high[3] = {0xB0, 7, 127};
+    uint32_t b, e, i, k, n = inter->nframes;
+    uint32_t frames[3] = {1, n / 3, n - 1};
+    uint32_t first, mismatched = 0;
+    double begin;
+    float *plain = malloc((size_t)blocks * n * sizeof(float));
+    float *split = malloc((size_t)blocks * n * sizeof(float));
+    compressor_parameters comp[2];
+    graph_parameters graph[2];
+    midi_parameters midi[2];
+    midi_event events[4];
+    if ((plain == NULL) || (split == NULL) || (n < 4)){
+        fprintf(stderr, "[ERROR] in midi benchmark initialisation - Needs at least 4 frames\n");
+        return 1;
+    }
+    printf("\nMIDI Control (compressor, controller 7 on gain_db)\n");
+    //No Events - The fast path
+    if (bench_midi_graph(&graph[0], &comp[0], &midi[0]) || bench_midi_graph(&graph[1], &comp[1], &midi[1])){
+        return 1;
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        graph_process(&x[b * n], &plain[b * n], &graph[0], inter);
+    }
+    bench_budget("graph_process", bench_time() - begin, blocks);
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        midi_process(&x[b * n], &split[b * n], &graph[1], inter, &midi[1], events, 0);
+    }
+    bench_budget("midi_process, no events", bench_time() - begin, blocks);
+    float diff = bench_error(plain, split, blocks * n);
+    printf("  max abs difference %g\n", diff);
+    //Unrelated Events - Clock, active sensing, a note and an unmapped controller, none of which split the period
+    //- Both graphs ran the same blocks above, so they continue from the same state
+    static const uint8_t clock[1] = {0xF8}, sensing[1] = {0xFE}, note[3] = {0x90, 60, 100}, cc_other[3] = {0xB0, 8, 64};
+    const uint8_t *unrelated[4] = {clock, sensing, note, cc_other};
+    for (i = 0; i < 4; i++){
+        events[i].time = ((i + 1) * n) / 5;
+        events[i].data = unrelated[i];
+        events[i].size = (i < 2) ? 1 : 3;
+    }
+    for (b = 0; b < blocks; b++){
+        graph_process(&x[b * n], &plain[b * n], &graph[0], inter);
+    }
+    begin = bench_time();
+    for (b = 0; b < blocks; b++){
+        midi_process(&x[b * n], &split[b * n], &graph[1], inter, &midi[1], events, 4);
+    }
+    bench_budget("midi_process, 4 unrelated events", bench_time() - begin, blocks);
+    float unrelated_diff = bench_error(plain, split, blocks * n);
+    printf("  max abs difference %g\n", unrelated_diff);
+    //Sample Accuracy - One event, 100 blocks in, at the start, a third of the way and the end of the period
+    for (k = 0; k < 3; k++){
+        graph_free(&graph[0]);
+        graph_free(&graph[1]);
+        if (bench_midi_graph(&graph[0], &comp[0], &midi[0]) || bench_midi_graph(&graph[1], &comp[1], &midi[1])){
+            return 1;
+        }
+        events[0].time = frames[k];
+        events[0].data = cc_low;
+        events[0].size = 3;
+        for (b = 0; (b <= 100) && (b < blocks); b++){
+            graph_process(&x[b * n], &plain[b * n], &graph[0], inter);
+            midi_process(&x[b * n], &split[b * n], &graph[1], inter, &midi[1], events, (b == 100) ? 1 : 0);
+        }
+        for (first = 0; (first < b * n) && (plain[first] == split[first]); first++){
+        }
+        printf("  event at frame %4u of block 100      first change at frame %u of block %u\n", frames[k], first % n, first / n);
+        mismatched += (first != 100 * n + frames[k]);
+    }
+    //Cost of Splitting - Every block carries 1, then 4, events alternating the gain
+    for (e = 1; e <= 4; e += 3){
+        char name[40];
+        for (i = 0; i < e; i++){
+            events[i].time = ((i + 1) * n) / (e + 1);
+            events[i].size = 3;
+        }
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            for (i = 0; i < e; i++){
+                events[i].data = ((b + i) & 1) ? cc_high : cc_low;
+            }
+            midi_process(&x[b * n], &split[b * n], &graph[1], inter, &midi[1], events, e);
+        }
+        snprintf(name, sizeof(name), "midi_process, %u event(s) per block", e);
+        bench_budget(name, bench_time() - begin, blocks);
+    }
+    graph_free(&graph[0]);
+    graph_free(&graph[1]);
+    free(plain);
+    free(split);
+    if ((diff != 0.0f) || (unrelated_diff != 0.0f) || mismatched){
+        fprintf(stderr, "[ERROR] MIDI changes were not applied at their frame, or changed a period without any\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Tracer Overhead - The same graph with recording paused and running, alternating and taking the quickest
+//pass of each to keep machine noise out of a difference of a few percent
+static inline int bench_trace(float *x, uint32_t blocks){
+    uint32_t b, pass, n = inter->nframes;
+    double begin, elapsed, best[2] = {1e30, 1e30};
+    float out[n];
+    compressor_parameters comp;
+    overdrive_parameters drive;
+    graph_parameters chain;
+    printf("\nTracer (compressor -> overdrive, as process() would record)\n");
+#ifndef TRACE
+    printf("  Not compiled in - Rebuild with make TRACE=1\n");
+    return 0;
+#endif
+    compressor_default(&comp);
+    compressor_init(&comp, inter);
+    overdrive_default(&drive);
+    graph_default(&chain);
+    //One begin/end pair per effect
+    if (overdrive_init(&drive, inter) ||
+        graph_add(&chain, "comp", GRAPH_COMPRESSOR, "in", &comp) ||
+        graph_add(&chain, "dirt", GRAPH_OVERDRIVE, "comp", &drive) ||
+        graph_compile(&chain, inter)){
+        return 1;
+    }
+    trace_thread("bench");
+    for (pass = 0; pass < 16; pass++){
+        uint32_t on = pass & 1;
+        trace_enable(on);
+        begin = bench_time();
+        for (b = 0; b < blocks; b++){
+            TRACE_BEGIN("process");
+            graph_process(&x[b * n], out, &chain, inter);
+            TRACE_END("process");
+        }
+        elapsed = bench_time() - begin;
+        best[on] = (elapsed < best[on]) ? elapsed : best[on];
+    }
+    trace_enable(0);
+    bench_report("recording paused", best[0], blocks);
+    bench_report("recording", best[1], blocks);
+    double period = (double)n / (double)inter->fs;
+    printf("  %.2f%% overhead (%.1f ns/block, %.3f%% of the period budget), %llu events held\n",
+           100.0 * (best[1] - best[0]) / best[0], 1e9 * (best[1] - best[0]) / (double)blocks,
+           100.0 * (best[1] - best[0]) / (double)blocks / period, (unsigned long long)trace_count());
+    if ((trace_path != NULL) && trace_dump(trace_path)){
+        return 1;
+    }
+    graph_free(&chain);
+    free(drive.window_store);
+    return 0;
+}
+
+//Live Period and Sample Rate Changes - As JACK's callbacks would, between blocks of one continuous render
+static inline int bench_resize(float *x, uint32_t blocks){
+    const uint32_t periods[6] = {256, 16, 128, 1024, 32, 64};
+    const uint32_t rates[6] = {48000, 48000, 44100, 44100, 96000, 48000};
+    uint32_t length = blocks * inter->nframes;
+    uint32_t nframes = inter->nframes, fs = inter->fs;
+    uint32_t change = length / 7;
+    uint32_t pos = 0, next = change, stage = 0, i, bad = 0;
+    double begin, elapsed, worst = 0.0, total = 0.0;
+    float *a = malloc(INTERFACE_MAX_NFRAMES * sizeof(float));
+    float *b = malloc(INTERFACE_MAX_NFRAMES * sizeof(float));
+    compressor_parameters comp;
+    overdrive_parameters drive;
+    delay_parameters dly;
+    octaver_parameters oct;
+    compressor_default(&comp);
+    overdrive_default(&drive);
+    delay_default(&dly);
+    octaver_default(&oct);
+    compressor_init(&comp, inter);
+    octaver_init(&oct, inter);
+    if ((a == NULL) || (b == NULL) || overdrive_init(&drive, inter) || delay_init(&dly, inter)){
+        fprintf(stderr, "[ERROR] in resize benchmark initialisation\n");
+        return 1;
+    }
+    printf("\nLive Resize (compressor -> overdrive -> delay -> octaver)\n");
+    while (pos + inter->nframes <= length){
+        if (pos >= next){
+            //Period and Sample Rate Callbacks
+            inter->nframes = periods[stage];
+            inter->fs = rates[stage];
+            begin = bench_time();
+            compressor_update(&comp, inter);
+            overdrive_update(&drive, inter);
+            delay_update(&dly, inter);
+            octaver_update(&oct, inter);
+            elapsed = bench_time() - begin;
+            worst = (elapsed > worst) ? elapsed : worst;
+            total += elapsed;
+            printf("  %5u frames at %6uHz                update %8.1f us\n", inter->nframes, inter->fs, 1e6 * elapsed);
+            stage++;
+            next += change;
+        }
+        compressor(&x[pos], a, &comp, inter);
+        overdrive(a, b, &drive, inter);
+        bench_window(&drive);
+        delay(b, a, &dly, inter);
+        octaver(a, b, &oct, inter);
+        for (i = 0; i < inter->nframes; i++){
+            bad += !(fabsf(b[i]) <= 16.0f);
+        }
+        pos += inter->nframes;
+    }
+    printf("  %-36s %10.1f us worst, %.1f us mean\n", "update", 1e6 * worst, 1e6 * total / (double)stage);
+    printf("  %-36s %10u\n", "non-finite or runaway samples", bad);
+    inter->nframes = nframes;
+    inter->fs = fs;
+    free(drive.window_store);
+    free(dly.ring);
+    free(a);
+    free(b);
+    if (bad){
+        fprintf(stderr, "[ERROR] Output broke after a live resize\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Tuner - process() only pays for tuner_push(), analysis runs here as it would on its thread
+static inline int bench_tuner(float *x, uint32_t blocks){
+    const float notes[4] = {41.20f, 55.00f, 73.42f, 98.00f};
+    const char *strings[4] = {"E1", "A1", "D2", "G2"};
+    float worst[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    uint32_t estimates[4] = {0, 0, 0, 0};
+    float freq, cents, err;
+    char name[5];
+    double push = 0.0, analyse = 0.0, begin;
+    uint32_t b, note, frame;
+    tuner_parameters tuner;
+    tuner_default(&tuner);
+    if (tuner_init(&tuner, inter)){
+        fprintf(stderr, "[ERROR] in tuner benchmark initialisation\n");
+        return 1;
+    }
+    printf("\nTuner\n");
+    for (b = 0; b < blocks; b++){
+        begin = bench_time();
+        tuner_push(&x[b * inter->nframes], &tuner, inter);
+        push += bench_time() - begin;
+        begin = bench_time();
+        int published = tuner_analyse(&tuner);
+        analyse += bench_time() - begin;
+        //Score estimates well inside each note (skip the attack and the release gap)
+        frame = (b * inter->nframes) % inter->fs;
+        note = ((b * inter->nframes) / inter->fs) % 4;
+        if (published && (frame > inter->fs / 4) && (frame < (inter->fs * 8) / 10)){
+            if (tuner_read(&tuner, &freq, &cents, name)){
+                err = fabsf(1200.0f * log2f(freq / notes[note]));
+            }
+            else{
+                err = 1200.0f;
+            }
+            worst[note] = fmaxf(worst[note], err);
+            estimates[note]++;
+        }
+    }
+    bench_budget("tuner_push (real-time path)", push, blocks);
+    bench_report("tuner_analyse (analysis thread)", analyse, blocks);
+    printf("  %-36s %10.3f%% of one core\n", "analysis load", 100.0 * analyse / ((double)blocks * inter->nframes / inter->fs));
+    printf("  %-36s %10u\n", "dropped blocks", atomic_load(&tuner.dropped));
+    for (note = 0; note < 4; note++){
+        printf("  %-36s %10.2f cents worst over %u estimates\n", strings[note], worst[note], estimates[note]);
+        if ((estimates[note] > 0) && (worst[note] > 5.0f)){
+            fprintf(stderr, "[ERROR] Tuner more than 5 cents out on %s\n", strings[note]);
+            tuner_free(&tuner);
+            return 1;
+        }
+    }
+    tuner_free(&tuner);
+    return 0;
+}
+
+int main (int argc, char *argv[]){
+    const char *benchmark = "all";
+    float validf;
+    int validi;
+    char err;
+    int i = 1;
+    //Parameter Memory Allocation
+    inter = malloc(sizeof(interface_parameters));
+    if (inter == NULL){
+        fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
+        exit(1);
+    }
+    if(interface_default(inter)){
+        fprintf(stderr,"[ERROR] in initialising interface defaults\n");
+        exit(1);
+    }
+    //Get Arguments
+    while (i < argc){
+        if (argv[i][0] != '-'){
+            benchmark = argv[i];
+            i++;
+        }
+        else if (i == (argc - 1)){
+            printf("[USER-ERROR] Not enough input arguments, please refer to usage guide below\n");
+            print_help();
+            exit(1);
+        }
+        else if ((strcmp(argv[i], "--nframes") == 0) && (sscanf(argv[i+1], "%d %c", &validi, &err) == 1) && (validi >= 1) && (validi <= INTERFACE_MAX_NFRAMES)){
+            inter->nframes = validi;
+            i+=2;
+        }
+        else if ((strcmp(argv[i], "--fs") == 0) && (sscanf(argv[i+1], "%d %c", &validi, &err) == 1) && (validi >= 44100) && (validi <= INTERFACE_MAX_FS)){
+            inter->fs = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--trace") == 0){
+            trace_path = argv[i+1];
+            i+=2;
+        }
+        else if ((strcmp(argv[i], "--seconds") == 0) && (sscanf(argv[i+1], "%f %c", &validf, &err) == 1) && (validf > 0.0f)){
+            seconds = validf;
+            i+=2;
+        }
+        else{
+            printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
+            print_help();
+            exit(1);
+        }
+    }
+    //Synthetic Input
+    uint32_t blocks = (uint32_t)(seconds * (float)inter->fs) / inter->nframes;
+    float *x = malloc(blocks * inter->nframes * sizeof(float));
+    if (x == NULL){
+        fprintf(stderr, "[ERROR] in test signal memory allocation\n");
+        exit(1);
+    }
+    bench_signal(x, blocks * inter->nframes);
+    printf("\n"
+           "/-----RASPBERRY RIPPLE BENCHMARK-----/\n"
+           "\n"
+           "%u blocks of %u frames at %uHz\n", blocks, inter->nframes, inter->fs);
+    //Run Benchmarks
+    int run = 0;
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "effects") == 0)){
+        if (bench_effects(x, blocks)){
+            fprintf(stderr, "[ERROR] in effects benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "anomaly") == 0)){
+        if (bench_anomaly(x, blocks)){
+            fprintf(stderr, "[ERROR] in anomaly benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "sweep") == 0)){
+        if (bench_sweep(x, blocks)){
+            fprintf(stderr, "[ERROR] in sweep benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "state") == 0)){
+        if (bench_state(x, blocks)){
+            fprintf(stderr, "[ERROR] in state benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "graph") == 0)){
+        if (bench_graph(x, blocks)){
+            fprintf(stderr, "[ERROR] in graph benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "pool") == 0)){
+        if (bench_pool(x, blocks)){
+            fprintf(stderr, "[ERROR] in pool benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "layout") == 0)){
+        if (bench_layout(x, blocks)){
+            fprintf(stderr, "[ERROR] in layout benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "subblock") == 0)){
+        if (bench_subblock(x, blocks)){
+            fprintf(stderr, "[ERROR] in subblock benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "control") == 0)){
+        if (bench_control(x, blocks)){
+            fprintf(stderr, "[ERROR] in control benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "stages") == 0)){
+        if (bench_stages(x, blocks)){
+            fprintf(stderr, "[ERROR] in stages benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "peak") == 0)){
+        if (bench_peak(x, blocks)){
+            fprintf(stderr, "[ERROR] in peak benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "midi") == 0)){
+        if (bench_midi(x, blocks)){
+            fprintf(stderr, "[ERROR] in midi benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "trace") == 0)){
+        if (bench_trace(x, blocks)){
+            fprintf(stderr, "[ERROR] in trace benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "resize") == 0)){
+        if (bench_resize(x, blocks)){
+            fprintf(stderr, "[ERROR] in resize benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if ((strcmp(benchmark, "all") == 0) || (strcmp(benchmark, "tuner") == 0)){
+        if (bench_tuner(x, blocks)){
+            fprintf(stderr, "[ERROR] in tuner benchmark\n");
+            exit(1);
+        }
+        run = 1;
+    }
+    if (!run){
+        printf("[USER-ERROR] Invalid benchmark '%s', please refer to usage guide below\n", benchmark);
+        print_help();
+        exit(1);
+    }
+    free(x);
+    exit(0);
+}
@@ -0,0 +1,430 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <jack/jack.h>
+#include <math.h>
+
+#define LATENCY_MLS_ORDER 14        //MLS Register Length - 2^14 - 1 frames per burst (~340ms at 48kHz)
+#define LATENCY_SETTLE 500000       //Wait after connecting, for JACK to recompute port latencies (us)
+#define LATENCY_POLL 10000          //Completion Poll Interval (us)
+#define LATENCY_CREST 8.0f          //Least correlation peak, over the correlation's rms, taken as a return
+
+jack_port_t *probe_out;
+jack_port_t *probe_in;
+jack_client_t *client;
+
+//Measurement Parameters
+uint32_t mls = 1;                       //Probe Signal - 1 for an MLS burst, 0 for an impulse
+uint32_t repeats = 10;                  //Bursts sent - Jitter is their spread
+float level = 0.5f;                     //Probe Level (peak)
+float max_ms = 100.0f;                  //Longest Round Trip searched (ms)
+const char *pedal = "raspberry_ripple"; //Pedal Client the probe is sent through - "none" for the bare loop
+const char *return_port = NULL;         //Port recorded as the return - Default is the first physical capture port
+//Probe and Recording - Burst k is sent from frame k * spacing, and the return recorded on the same frame count
+float *stimulus;
+uint32_t stimulus_len, max_lag, spacing, total;
+float *recording;
+volatile uint32_t armed = 0;
+volatile uint32_t pos = 0;
+//Pedal Input - The connections moved aside for the probe, put back however the program exits
+char sink[256];
+const char **moved = NULL;
+volatile sig_atomic_t interrupted = 0;
+
+static inline void print_about(){
+    printf("\n"
+           "Raspberry Ripple - A Programmable Bass Guitar Effects Pedal\n"
+           "(c) Copyright 2020, Andy Silk (@silkyandrew97)\n"
+           "MIT License\n"
+           "Project Home: https://github.com/silkyandrew97/raspberry_ripple\n"
+           "\n");
+}
+
+static inline void print_help(){
+    printf("\n"
+           "Usage:\n"
+           "  rripple_latency [Additional Arguments]\n"
+           "\n"
+           "Sends a probe through the running pedal and a loopback path, and cross-correlates the return\n"
+           "to measure the actual round trip and its jitter, against the latency JACK reports for the path\n"
+           "\n"
+           "  e.g. rripple_latency --signal impulse --repeats 20\n"
+           "       rripple_latency --return raspberry_ripple:output   (JACK loopback, e.g. on the dummy backend)\n"
+           "\n"
+           "Additional Arguments (s, u and f denote string, unsigned integer and float values respectively:\n"
+           "\n"
+           "    [--signal s]        Probe Signal - impulse or mls (maximum length sequence)\n"
+           "                        Default is mls\n"
+           "    [--repeats u]       Bursts Sent - Must be in the range 2 to 1000\n"
+           "                        Default is 10\n"
+           "    [--level f]         Probe Level (peak) - Must be more than 0, and at most 1\n"
+           "                        Default is 0.5f\n"
+           "    [--max f]           Longest Round Trip searched (ms) - Must be more than 0, and at most 1000\n"
+           "                        Default is 100.0f\n"
+           "    [--pedal s]         Pedal Client the probe is sent through - none measures the bare loop\n"
+           "                        Default is raspberry_ripple\n"
+           "    [--return s]        Port recorded as the return - e.g. a physical capture port cabled to the output\n"
+           "                        Default is the first physical capture port\n"
+           "\n");
+}
+
+static inline int get_args(int argc, char *argv[]){
+    float validf;
+    int validi;
+    char err;
+    int i = 1;
+    while (i < argc){
+        if (i == (argc - 1)){
+            printf("[USER-ERROR] Not enough input arguments, please refer to usage guide below\n");
+            print_help();
+            exit(1);
+        }
+        else if (strcmp(argv[i], "--signal") == 0){
+            if (strcmp(argv[i+1], "mls") == 0){
+                mls = 1;
+            }
+            else if (strcmp(argv[i+1], "impulse") == 0){
+                mls = 0;
+            }
+            else{
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--repeats") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 2) || (validi > 1000)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            repeats = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--level") == 0){
+            if ((sscanf(argv[i+1], "%f %c", &validf, &err) != 1) || !(validf > 0.0f) || (validf > 1.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            level = validf;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--max") == 0){
+            if ((sscanf(argv[i+1], "%f %c", &validf, &err) != 1) || !(validf > 0.0f) || (validf > 1000.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            max_ms = validf;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--pedal") == 0){
+            pedal = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--return") == 0){
+            return_port = argv[i+1];
+            i+=2;
+        }
+        else{
+            printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
+            print_help();
+            exit(1);
+        }
+    }
+    return 0;
+}
+
+//Probe Signal - One MLS period from a maximal Fibonacci LFSR (taps 14, 13, 12, 2), or a unit impulse
+static inline int make_stimulus(){
+    stimulus_len = mls ? (1u << LATENCY_MLS_ORDER) - 1 : 1;
+    stimulus = (float*)malloc(stimulus_len * sizeof(float));
+    if (stimulus == NULL){
+        fprintf(stderr, "[ERROR] in stimulus memory allocation\n");
+        return 1;
+    }
+    uint32_t reg = 1, bit;
+    for (uint32_t i = 0; i < stimulus_len; i++){
+        stimulus[i] = (mls && !(reg & 1)) ? -1.0f : 1.0f;
+        bit = ((reg >> 13) ^ (reg >> 12) ^ (reg >> 11) ^ (reg >> 1)) & 1;
+        reg = ((reg << 1) | bit) & ((1u << LATENCY_MLS_ORDER) - 1);
+    }
+    return 0;
+}
+
+//Process Callback Function - Sends each burst and records the return on the same frame count, so the
+//round trip is the lag between them
+int process (jack_nframes_t nframes, void *arg){
+    jack_default_audio_sample_t *out = jack_port_get_buffer (probe_out, nframes);
+    jack_default_audio_sample_t *in = jack_port_get_buffer (probe_in, nframes);
+    if (!armed){
+        memset(out, 0, nframes * sizeof(jack_default_audio_sample_t));
+        return 0;
+    }
+    uint32_t p = pos;
+    for (uint32_t i = 0; i < nframes; i++, p++){
+        uint32_t k = p % spacing;
+        out[i] = ((p < total) && (k < stimulus_len)) ? level * stimulus[k] : 0.0f;
+        if (p < total){
+            recording[p] = in[i];
+        }
+    }
+    pos = p;
+    return 0;
+}
+
+//Shut Down Callback - if client is disconnected
+void jack_shutdown (void *arg){
+    exit (1);
+}
+
+//Cross-Correlate one burst's return against the probe - Returns the round trip (frames), interpolated
+//between lags, and the correlation peak over its rms
+static inline float correlate(const float *rec, float *corr, float *crest){
+    uint32_t lag, i, best = 0;
+    float sum2 = 0.0f, c;
+    for (lag = 0; lag <= max_lag; lag++){
+        c = 0.0f;
+        for (i = 0; i < stimulus_len; i++){
+            c += stimulus[i] * rec[lag + i];
+        }
+        //Magnitude - An inverting path still returns
+        corr[lag] = fabsf(c);
+        sum2 += c * c;
+        if (corr[lag] > corr[best]){
+            best = lag;
+        }
+    }
+    float rms = sqrtf(sum2 / (float)(max_lag + 1));
+    *crest = (rms > 0.0f) ? corr[best] / rms : 0.0f;
+    //Parabolic Interpolation between lags
+    float shift = 0.0f;
+    if ((best > 0) && (best < max_lag)){
+        float den = corr[best - 1] - 2.0f * corr[best] + corr[best + 1];
+        shift = (den < 0.0f) ? 0.5f * (corr[best - 1] - corr[best + 1]) / den : 0.0f;
+    }
+    return (float)best + shift;
+}
+
+//Move every connection into a port aside, so only the probe reaches it - Returns the sources, to restore
+static inline const char **isolate(const char *port){
+    jack_port_t *p = jack_port_by_name (client, port);
+    if (p == NULL){
+        return NULL;
+    }
+    const char **sources = jack_port_get_all_connections (client, p);
+    for (uint32_t i = 0; (sources != NULL) && (sources[i] != NULL); i++){
+        jack_disconnect (client, sources[i], port);
+    }
+    return sources;
+}
+
+//Put the Pedal's Input back - Registered with atexit() once isolate() has run, so every exit restores it
+static void restore(void){
+    for (uint32_t i = 0; (moved != NULL) && (moved[i] != NULL); i++){
+        jack_connect (client, moved[i], sink);
+    }
+    if (moved != NULL){
+        jack_free (moved);
+        moved = NULL;
+    }
+}
+
+//Interrupt Handler - The wait loop exits, so restore() runs off the signal handler
+static void INThandler(int sig){
+    interrupted = 1;
+}
+
+int main (int argc, char *argv[]){
+    char capture_name[256];
+    const char **ports;
+    jack_status_t status;
+    //Get Parameter Arguments
+    if(get_args(argc, argv)){
+        fprintf(stderr,"[ERROR] in getting parameter arguments\n");
+        exit(1);
+    }
+    if (make_stimulus()){
+        exit(1);
+    }
+    //JACK Initialisation - Joins the server the pedal is running on
+    client = jack_client_open ("rripple_latency", JackNoStartServer, &status, NULL);
+    if (client == NULL){
+        fprintf (stderr, "[JACK-ERROR] jack_client_open() failed, status = 0x%2.0x\n", status);
+        if (status & JackServerFailed){
+            fprintf (stderr, "[JACK-ERROR] Unable to connect to JACK server - Start the pedal first\n");
+        }
+        exit (1);
+    }
+    uint32_t fs = jack_get_sample_rate (client);
+    uint32_t nframes = jack_get_buffer_size (client);
+    jack_set_process_callback (client, process, 0);
+    jack_on_shutdown (client, jack_shutdown, 0);
+    probe_out = jack_port_register (client, "probe_out",
+                    JACK_DEFAULT_AUDIO_TYPE,
+                    JackPortIsOutput, 0);
+    probe_in = jack_port_register (client, "probe_in",
+                   JACK_DEFAULT_AUDIO_TYPE,
+                   JackPortIsInput, 0);
+    if ((probe_out == NULL) || (probe_in == NULL)){
+        fprintf(stderr, "[JACK-ERROR] Cannot register JACK ports\n");
+        exit (1);
+    }
+    //Recording Memory Allocation - Each burst is followed by silence for the longest round trip searched
+    max_lag = (uint32_t)(max_ms * 0.001f * (float)fs);
+    spacing = stimulus_len + max_lag + 1;
+    total = repeats * spacing;
+    recording = (float*)calloc(total, sizeof(float));
+    float *corr = (float*)malloc((max_lag + 1) * sizeof(float));
+    float *trips = (float*)malloc(repeats * sizeof(float));
+    if ((recording == NULL) || (corr == NULL) || (trips == NULL)){
+        fprintf(stderr, "[ERROR] in recording memory allocation\n");
+        exit(1);
+    }
+    printf("\n"
+    "/-----RASPBERRY RIPPLE LATENCY-----/\n");
+    print_about();
+    if (jack_activate (client)){
+        fprintf (stderr, "[JACK-ERROR] Cannot activate client");
+        exit (1);
+    }
+    //Send Path - Probe into the pedal in place of its input, or straight to the first physical playback port
+    if (strcmp(pedal, "none") == 0){
+        ports = jack_get_ports (client, NULL, NULL, JackPortIsPhysical|JackPortIsInput);
+        if (ports == NULL){
+            fprintf(stderr, "[JACK-ERROR] No physical playback ports\n");
+            exit (1);
+        }
+        snprintf(sink, sizeof(sink), "%s", ports[0]);
+        jack_free (ports);
+    }
+    else{
+        snprintf(sink, sizeof(sink), "%s:input", pedal);
+        if (jack_port_by_name (client, sink) == NULL){
+            printf("[USER-ERROR] No port '%s' - Is the pedal running?\n", sink);
+            exit (1);
+        }
+        moved = isolate(sink);
+        atexit(restore);
+        signal(SIGINT, INThandler);
+    }
+    //Return Path - A physical capture port cabled to the output, or any port for a JACK loopback
+    if (return_port == NULL){
+        ports = jack_get_ports (client, NULL, NULL, JackPortIsPhysical|JackPortIsOutput);
+        if (ports == NULL){
+            fprintf(stderr, "[JACK-ERROR] No physical capture ports\n");
+            exit (1);
+        }
+        snprintf(capture_name, sizeof(capture_name), "%s", ports[0]);
+        jack_free (ports);
+        return_port = capture_name;
+    }
+    jack_port_t *ret = jack_port_by_name (client, return_port);
+    if (ret == NULL){
+        printf("[USER-ERROR] No port '%s' for '--return'\n", return_port);
+        exit (1);
+    }
+    if (jack_connect (client, jack_port_name (probe_out), sink) ||
+        jack_connect (client, return_port, jack_port_name (probe_in))){
+        fprintf (stderr, "[JACK-ERROR] Cannot connect the probe ports\n");
+        exit (1);
+    }
+    //Reported Latency - The playback side the probe reaches, plus the capture side of the return
+    jack_recompute_total_latencies (client);
+    usleep(LATENCY_SETTLE);
+    jack_latency_range_t play, capture;
+    jack_port_get_latency_range (probe_out, JackPlaybackLatency, &play);
+    jack_port_get_latency_range (ret, JackCaptureLatency, &capture);
+    uint32_t physical = (jack_port_flags (ret) & JackPortIsPhysical) != 0;
+    //Run Measurement
+    printf("Sending %u %s burst(s) from '%s' into '%s', returning from '%s'...\n",
+           repeats, mls ? "MLS" : "impulse", jack_port_name (probe_out), sink, return_port);
+    armed = 1;
+    uint32_t waited = 0, timeout = (uint32_t)(1e6f * (float)total / (float)fs) + 5000000;
+    while (pos < total){
+        usleep(LATENCY_POLL);
+        waited += LATENCY_POLL;
+        if (waited > timeout){
+            fprintf(stderr, "[JACK-ERROR] Process callback stopped before the last burst returned\n");
+            exit (1);
+        }
+        if (interrupted){
+            printf("\nInterrupted - Restoring the pedal's input\n");
+            exit (1);
+        }
+    }
+    jack_deactivate (client);
+    //Restore the Pedal's Input
+    restore();
+    //Round Trip per Burst
+    printf("\n"
+           "/-----LATENCY RESULTS-----/\n"
+           "\n");
+    uint32_t found = 0;
+    float crest, sum = 0.0f, lo = 0.0f, hi = 0.0f;
+    for (uint32_t k = 0; k < repeats; k++){
+        float trip = correlate(&recording[k * spacing], corr, &crest);
+        if (crest < LATENCY_CREST){
+            printf("  burst %4u   no return found (peak %.1fx rms)\n", k + 1, crest);
+            continue;
+        }
+        printf("  burst %4u %10.2f frames %8.3f ms (peak %.1fx rms)\n", k + 1, trip, 1000.0f * trip / (float)fs, crest);
+        trips[found++] = trip;
+    }
+    if (found == 0){
+        printf("[USER-ERROR] No burst returned within %.1fms - Check the loopback path and '--max'\n", max_ms);
+        jack_client_close (client);
+        exit (1);
+    }
+    lo = trips[0];
+    hi = trips[0];
+    for (uint32_t k = 0; k < found; k++){
+        sum += trips[k];
+        lo = (trips[k] < lo) ? trips[k] : lo;
+        hi = (trips[k] > hi) ? trips[k] : hi;
+    }
+    float mean = sum / (float)found, var = 0.0f;
+    for (uint32_t k = 0; k < found; k++){
+        var += (trips[k] - mean) * (trips[k] - mean);
+    }
+    float sd = sqrtf(var / (float)found);
+    printf("\n"
+           "Period:               %u frames at %uHz\n"
+           "Bursts returned:      %u of %u\n"
+           "Round trip:           mean %.2f frames (%.3f ms), min %.2f, max %.2f\n"
+           "Jitter:               %.2f frames std dev (%.1f us), %.2f frames peak to peak\n",
+           nframes, fs, found, repeats, mean, 1000.0f * mean / (float)fs, lo, hi,
+           sd, 1e6f * sd / (float)fs, hi - lo);
+    //Reported against Measured - Only a hardware loop has a reported round trip
+    if (physical){
+        uint32_t reported = play.max + capture.max;
+        float unreported = mean - (float)reported;
+        printf("Reported by JACK:     %u frames (%.3f ms) - playback %u-%u, capture %u-%u\n"
+               "Unreported:           %.2f frames (%.3f ms)\n",
+               reported, 1000.0f * (float)reported / (float)fs, play.min, play.max, capture.min, capture.max,
+               unreported, 1000.0f * unreported / (float)fs);
+        if (fabsf(unreported) > 1.0f){
+            printf("[USER-WARNING] Reported latency is %s by %.0f frames - Converter and USB latency are not\n"
+                   "               known to JACK, pass them to jackd with -I and -O\n",
+                   (unreported > 0.0f) ? "short" : "over", fabsf(unreported));
+        }
+    }
+    else{
+        printf("Reported by JACK:     not compared - '%s' is not a physical port, so the loop is internal to JACK\n", return_port);
+    }
+    jack_client_close (client);
+    free(stimulus);
+    free(recording);
+    free(corr);
+    free(trips);
+    exit ((found == repeats) ? 0 : 2);
+}
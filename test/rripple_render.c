@@ -0,0 +1,278 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rripple.h"
+#include "wav.h"
+
+#define RENDER_MAX_SETS 64          //Most --set Arguments
+#define RENDER_LINE 256             //Longest Automation Line (including terminator)
+
+//Render Parameters
+const char *input = NULL;           //WAV file rendered
+const char *output = NULL;          //WAV file written - Mono 32-bit float
+const char *graph_path = NULL;      //Graph Description - Default is compressor -> overdrive
+uint32_t block = 64;                //Block (frames) the effects run in
+char *sets[RENDER_MAX_SETS];        //Parameters, as "<node>.<parameter>=<value>"
+uint32_t nsets = 0;
+const char *automation_path = NULL; //Automation Timeline - Default is none
+
+typedef struct{
+    rripple_point point;
+    uint32_t line;                  //Line of the timeline, for messages and to keep points at one frame in order
+} render_point;
+
+static inline void print_help(){
+    printf("\n"
+           "Usage:\n"
+           "  rripple_render <input> <output> [Additional Arguments]\n"
+           "\n"
+           "Where:\n"
+           "  input                 WAV file rendered - 16/24/32-bit PCM or 32-bit float, first channel only\n"
+           "  output                WAV file written - Mono 32-bit float at the input's sample rate\n"
+           "\n"
+           "  e.g. rripple_render res/test_recordings/1/12/120.wav out.wav --set overdrive.drive=0.8\n"
+           "\n"
+           "Additional Arguments (s and u denote string and unsigned integer values respectively:\n"
+           "\n"
+           "    [--graph s]         Effect Graph Description (see res/graphs)\n"
+           "                        Default is compressor -> overdrive, nodes named compressor and overdrive\n"
+           "    [--block u]         Block (frames) - A power of two in the range 16 to 4096\n"
+           "                        Default is 64\n"
+           "    [--set s]           Parameter as <node>.<parameter>=<value>, or subblock= - Repeatable\n"
+           "                        e.g. --set compressor.compression_db=9 --set subblock=16\n"
+           "    [--automation s]    Automation Timeline - One <time (s)> <node>.<parameter>=<value> per line,\n"
+           "                        with bypass toggles as <node>.bypass=0|1 (see res/automation)\n"
+           "                        Each point is applied at its exact frame, points at one time in file order\n"
+           "                        Blank lines and lines starting with # are skipped\n"
+           "\n");
+}
+
+static inline int get_args(int argc, char *argv[]){
+    int validi;
+    char err;
+    int i = 1;
+    while (i < argc){
+        if (strncmp(argv[i], "--", 2) != 0){
+            if (input == NULL){
+                input = argv[i];
+            }
+            else if (output == NULL){
+                output = argv[i];
+            }
+            else{
+                printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
+                print_help();
+                exit(1);
+            }
+            i++;
+        }
+        else if (i == (argc - 1)){
+            printf("[USER-ERROR] Not enough input arguments, please refer to usage guide below\n");
+            print_help();
+            exit(1);
+        }
+        else if (strcmp(argv[i], "--graph") == 0){
+            graph_path = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--block") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 16) || (validi > 4096) || ((validi & (validi - 1)) != 0)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            block = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--automation") == 0){
+            automation_path = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--set") == 0){
+            if ((nsets == RENDER_MAX_SETS) || (strchr(argv[i+1], '=') == NULL)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            sets[nsets++] = argv[i+1];
+            i+=2;
+        }
+        else{
+            printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
+            print_help();
+            exit(1);
+        }
+    }
+    if ((input == NULL) || (output == NULL)){
+        printf("[USER-ERROR] Needs an input and an output file, please refer to usage guide below\n");
+        print_help();
+        exit(1);
+    }
+    return 0;
+}
+
+//Chain - From a graph description, or the pedal's default order, with the --set parameters applied
+static inline rripple *make_chain(uint32_t fs, rripple **comp, rripple **drive){
+    rripple *chain;
+    float value;
+    char err;
+    if (graph_path != NULL){
+        chain = rripple_chain_load(graph_path, fs, block);
+    }
+    else{
+        chain = rripple_chain_create(fs, block);
+        *comp = rripple_create(RRIPPLE_COMPRESSOR, fs, block);
+        *drive = rripple_create(RRIPPLE_OVERDRIVE, fs, block);
+        if ((chain == NULL) || (*comp == NULL) || (*drive == NULL) ||
+            rripple_chain_add(chain, "compressor", RRIPPLE_COMPRESSOR, "in", *comp) ||
+            rripple_chain_add(chain, "overdrive", RRIPPLE_OVERDRIVE, "compressor", *drive)){
+            rripple_destroy(chain);
+            chain = NULL;
+        }
+    }
+    if (chain == NULL){
+        fprintf(stderr, "[ERROR] in creating the render chain\n");
+        exit(1);
+    }
+    for (uint32_t s = 0; s < nsets; s++){
+        char key[RENDER_LINE];
+        const char *eq = strchr(sets[s], '=');
+        snprintf(key, sizeof(key), "%.*s", (int)(eq - sets[s]), sets[s]);
+        if ((sscanf(eq + 1, "%f %c", &value, &err) != 1) || rripple_set(chain, key, value)){
+            printf("[USER-ERROR] Invalid parameter '%s'\n", sets[s]);
+            exit(1);
+        }
+    }
+    return chain;
+}
+
+//Points at the same frame stay in timeline order
+static int compare_points(const void *a, const void *b){
+    const render_point *pa = (const render_point*)a;
+    const render_point *pb = (const render_point*)b;
+    if (pa->point.frame != pb->point.frame){
+        return (pa->point.frame < pb->point.frame) ? -1 : 1;
+    }
+    return (pa->line < pb->line) ? -1 : (pa->line > pb->line);
+}
+
+//Load the Automation Timeline - Points sorted by frame, with their keys allocated alongside
+static inline render_point *load_automation(uint32_t fs, uint32_t *npoints){
+    FILE *file = fopen(automation_path, "r");
+    char line[RENDER_LINE], setting[RENDER_LINE], err;
+    uint32_t number = 0, capacity = 0;
+    render_point *points = NULL;
+    double time;
+    float value;
+    if (file == NULL){
+        printf("[USER-ERROR] Could not open automation '%s'\n", automation_path);
+        exit(1);
+    }
+    *npoints = 0;
+    while (fgets(line, sizeof(line), file) != NULL){
+        number++;
+        char *text = line + strspn(line, " \t");
+        //Comments and Blank Lines
+        if ((*text == '#') || (*text == '\n') || (*text == '\r') || (*text == '\0')){
+            continue;
+        }
+        char *eq = (sscanf(text, "%lf %255s %c", &time, setting, &err) == 2) ? strchr(setting, '=') : NULL;
+        if ((eq == NULL) || (time < 0.0) || (sscanf(eq + 1, "%f %c", &value, &err) != 1)){
+            printf("[USER-ERROR] Expected '<time (s)> <node>.<parameter>=<value>' on line %u of automation\n", number);
+            exit(1);
+        }
+        if (*npoints == capacity){
+            capacity = (capacity == 0) ? 256 : 2 * capacity;
+            points = (render_point*)realloc(points, capacity * sizeof(render_point));
+            if (points == NULL){
+                fprintf(stderr, "[ERROR] in automation memory allocation\n");
+                exit(1);
+            }
+        }
+        *eq = '\0';
+        render_point *point = &points[(*npoints)++];
+        point->point.frame = (uint64_t)(time * (double)fs + 0.5);
+        point->point.key = strdup(setting);
+        point->point.value = value;
+        point->line = number;
+        if (point->point.key == NULL){
+            fprintf(stderr, "[ERROR] in automation memory allocation\n");
+            exit(1);
+        }
+    }
+    fclose(file);
+    qsort(points, *npoints, sizeof(render_point), compare_points);
+    return points;
+}
+
+int main (int argc, char *argv[]){
+    wav_file wav;
+    rripple *chain, *comp = NULL, *drive = NULL;
+    rripple_point *timeline = NULL;
+    uint32_t npoints = 0;
+    //Get Parameter Arguments
+    if(get_args(argc, argv)){
+        fprintf(stderr,"[ERROR] in getting parameter arguments\n");
+        exit(1);
+    }
+    if (rripple_version() != RRIPPLE_VERSION){
+        fprintf(stderr, "[ERROR] librripple API version %u, built against %u\n", rripple_version(), RRIPPLE_VERSION);
+        exit(1);
+    }
+    if (wav_read(input, &wav)){
+        exit(1);
+    }
+    chain = make_chain(wav.fs, &comp, &drive);
+    //Automation - Every point is first tried on a started copy of the chain, so a bad line stops the render before it begins
+    if (automation_path != NULL){
+        render_point *points = load_automation(wav.fs, &npoints);
+        rripple *check_comp = NULL, *check_drive = NULL;
+        rripple *check = make_chain(wav.fs, &check_comp, &check_drive);
+        float silence = 0.0f;
+        rripple_process(check, &silence, &silence, 0);
+        timeline = (rripple_point*)malloc((npoints + 1) * sizeof(rripple_point));
+        if (timeline == NULL){
+            fprintf(stderr, "[ERROR] in automation memory allocation\n");
+            exit(1);
+        }
+        for (uint32_t p = 0; p < npoints; p++){
+            if (rripple_set(check, points[p].point.key, points[p].point.value)){
+                printf("[USER-ERROR] Invalid parameter on line %u of automation\n", points[p].line);
+                exit(1);
+            }
+            timeline[p] = points[p].point;
+        }
+        rripple_destroy(check);
+        rripple_destroy(check_comp);
+        rripple_destroy(check_drive);
+        free(points);
+    }
+    //Render in Place - The whole file in one call, split into blocks (and at each point) by the library
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    int faults = rripple_process_automation(chain, wav.data, wav.data, wav.length, timeline, npoints);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (double)(end.tv_sec - begin.tv_sec) + 1e-9 * (double)(end.tv_nsec - begin.tv_nsec);
+    if (wav_write(output, &wav)){
+        exit(1);
+    }
+    printf("Rendered %u frames at %uHz with %u automation point(s) in %.3fs (%.1fx real-time) to '%s'\n",
+           wav.length, wav.fs, npoints, elapsed, ((double)wav.length / (double)wav.fs) / elapsed, output);
+    if (faults & 1){
+        printf("[USER-WARNING] Some blocks faulted and were silenced\n");
+    }
+    rripple_destroy(chain);
+    rripple_destroy(comp);
+    rripple_destroy(drive);
+    for (uint32_t p = 0; p < npoints; p++){
+        free((char*)timeline[p].key);
+    }
+    free(timeline);
+    wav_free(&wav);
+    return faults;
+}
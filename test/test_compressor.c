@@ -27,6 +27,7 @@ jack_client_t *client;
 interface_parameters *inter;
 overdrive_parameters *drive;
 compressor_parameters *comp;
+compressor_sweep_parameters *sweep;
 test_timer timer = {
     {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f},
     {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}
@@ -272,36 +273,6 @@ static inline int get_args(int argc, char *argv[]){
     return 0;
 }
 
-static inline float db2lin(float db){
-    return powf(10.0f, 0.05f * db);
-}
-
-static inline void effects_chain(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, overdrive_parameters *drive, interface_parameters *inter){
-    if (comp->chain == 1){
-        if (compressor(in, out, comp, inter)){
-            fprintf(stderr,"[ERROR] in compressor effect\n");
-            exit(1);
-        }
-        if (drive->chain == 2){
-            overdrive(out, out, drive, inter);
-        }
-    }
-    else if (drive->chain == 1){
-        overdrive(in, out, drive, inter);
-        if (comp->chain == 2){
-            if (compressor(out, out, comp, inter)){
-                fprintf(stderr,"[ERROR] in compressor effect\n");
-                exit(1);
-            }
-        }
-    }
-    else{
-        memcpy(out, in, (sizeof(jack_default_audio_sample_t) * inter->nframes));
-        fprintf(stderr, "[ERROR] in main process\n");
-        exit(1);
-    }
-}
-
 static inline void timer_calcs(float *t, clock_t begin, clock_t end){
     t[0] = (float)(end - begin) / CLOCKS_PER_SEC;
     if(t[0]>t[1]){
@@ -325,103 +296,21 @@ int process (jack_nframes_t nframes, void *arg){
     out_5 = jack_port_get_buffer (output_port_5, nframes);
     out_6 = jack_port_get_buffer (output_port_6, nframes);
     
-    //Control Params
-    float gs[2] = {comp->gs[0], comp->gs[1]};
-    
-    //Global Params
-    comp->chain = 1;
-    drive->chain = 0;
+    jack_default_audio_sample_t *out[6] = {out_1, out_2, out_3, out_4, out_5, out_6};
     
-    //out_1 Timer Start
+    //Sweep Timer Start
     begin = clock();
-    //Params - Compression = 0.0
-    comp->compression_db = 0.0f;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    //Adjust Dependants
-    comp->comps = db2lin(comp->compression_db) - 1.0f;
+    //Params - Compression = 0.0, 3.0, 6.0, 9.0, 12.0 and 15.0, one variant per sweep lane
     //Effect
-    effects_chain(in, out_1, comp, drive, inter);
-    //out_1 Timer End
+    if (compressor_sweep(in, out, sweep, inter)){
+        fprintf(stderr,"[ERROR] in compressor sweep\n");
+        exit(1);
+    }
+    //Sweep Timer End
     end = clock();
-    //out_1 Timer Calculations
+    //Sweep Timer Calculations
     timer_calcs(timer.t1, begin, end);
     
-    //out_2 Timer Start
-    begin = clock();
-    //Params - Compression = 3.0
-    comp->compression_db = 3.0f;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    //Adjust Dependants
-    comp->comps = db2lin(comp->compression_db) - 1.0f;
-    //Effect
-    effects_chain(in, out_2, comp, drive, inter);
-    //out_2 Timer End
-    end = clock();
-    //out_2 Timer Calculations
-    timer_calcs(timer.t2, begin, end);
-    
-    //out_3 Timer Start
-    begin = clock();
-    //Params - Compression = 6.0
-    comp->compression_db = 6.0f;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    //Adjust Dependants
-    comp->comps = db2lin(comp->compression_db) - 1.0f;
-    //Effect
-    effects_chain(in, out_3, comp, drive, inter);
-    //out_3 Timer End
-    end = clock();
-    //out_3 Timer Calculations
-    timer_calcs(timer.t3, begin, end);
-    
-    //out_4 Timer Start
-    begin = clock();
-    //Params - Compression = 9.0
-    comp->compression_db = 9.0f;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    //Adjust Dependants
-    comp->comps = db2lin(comp->compression_db) - 1.0f;
-    //Effect
-    effects_chain(in, out_4, comp, drive, inter);
-    //out_4 Timer End
-    end = clock();
-    //out_4 Timer Calculations
-    timer_calcs(timer.t4, begin, end);
-    
-    //out_5 Timer Start
-    begin = clock();
-    //Params - Compression = 12.0
-    comp->compression_db = 12.0f;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    //Adjust Dependants
-    comp->comps = db2lin(comp->compression_db) - 1.0f;
-    //Effect
-    effects_chain(in, out_5, comp, drive, inter);
-    //out_5 Timer End
-    end = clock();
-    //out_5 Timer Calculations
-    timer_calcs(timer.t5, begin, end);
-    
-    //out_6 Timer Start
-    begin = clock();
-    //Params - Compression = 15.0
-    comp->compression_db = 15.0f;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    //Adjust Dependants
-    comp->comps = db2lin(comp->compression_db) - 1.0f;
-    //Effect
-    effects_chain(in, out_6, comp, drive, inter);
-    //out_6 Timer End
-    end = clock();
-    //out_6 Timer Calculations
-    timer_calcs(timer.t6, begin, end);
-    
     //Overall Timer End
     overall_end = clock();
     //Overall Timer Calculations
@@ -443,12 +332,12 @@ int main (int argc, char *argv[]){
         fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
         exit(1);
     }
-    comp = malloc(sizeof(compressor_parameters));
+    comp = sample_alloc(sizeof(compressor_parameters));
     if (comp == NULL){
         fprintf(stderr, "[ERROR] in compressor_parameters memory allocation\n");
         exit(1);
     }
-    drive = malloc(sizeof(overdrive_parameters));
+    drive = sample_alloc(sizeof(overdrive_parameters));
     if (drive == NULL){
         fprintf(stderr, "[ERROR] in overdrive_parameters memory allocation\n");
         exit(1);
@@ -475,6 +364,18 @@ int main (int argc, char *argv[]){
         fprintf(stderr,"[ERROR] in overdrive parameter initialisation\n");
         exit(1);
     }
+    //Sweep Initialisation - Compression = 0.0, 3.0, 6.0, 9.0, 12.0 and 15.0
+    sweep = malloc(sizeof(compressor_sweep_parameters));
+    if (sweep == NULL){
+        fprintf(stderr, "[ERROR] in compressor_sweep_parameters memory allocation\n");
+        exit(1);
+    }
+    compressor_sweep_default(sweep, comp);
+    sweep->lanes = 6;
+    for (uint32_t k = 0; k < sweep->lanes; k++){
+        sweep->compression_db[k] = 3.0f * (float)k;
+    }
+    compressor_sweep_init(sweep, inter);
     
     //JACK Initialisation
     const char **ports;
@@ -0,0 +1,523 @@
+//Copyright (C) 2020, Andy Silk (@silkyandrew97)
+//MIT License
+//Project Home: https://github.com/silkyandrew97/raspberry_ripple
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <jack/jack.h>
+#include <math.h>
+#include "graph.h"
+#include "interface.h"
+#include "wav.h"
+#include "logger.h"
+#include "test.h"
+
+#define PI 3.14159265f
+#define CPU_LOAD_INTERVAL 100000
+
+jack_port_t *input_port;
+jack_port_t *output_port;
+jack_port_t *player_port;
+jack_client_t *client;
+jack_client_t *player;
+
+interface_parameters *inter;
+graph_parameters *graph;
+
+//Effect Chain - Effects named on the command line, in order, or a graph description
+const char *chain[GRAPH_MAX_NODES - 1];
+uint32_t chain_len = 0;
+char *graph_path = NULL;
+//Load Test Parameters
+char *file = NULL;              //Playback file - Default is a synthetic bass signal
+float seconds = 10.0f;          //Test Duration (s)
+wav_file playback;
+uint32_t playback_pos = 0;
+//Per-Callback Timings - Preallocated for the whole run
+float *callback_t;              //Time spent in each process callback (s)
+float *interval_t;              //Time between successive process callbacks (s)
+uint32_t max_callbacks;
+volatile uint32_t callbacks = 0;
+volatile uint32_t xruns = 0;
+struct timespec last_callback;
+
+static inline void print_about(){
+    printf("\n"
+           "Raspberry Ripple - A Programmable Bass Guitar Effects Pedal\n"
+           "(c) Copyright 2020, Andy Silk (@silkyandrew97)\n"
+           "MIT License\n"
+           "Project Home: https://github.com/silkyandrew97/raspberry_ripple\n"
+           "\n");
+}
+
+static inline void print_help(){
+    printf("\n"
+           "Usage:\n"
+           "  test_load <effect_1> ... <effect_n> [Additional Arguments]\n"
+           "  test_load --graph <file> [Additional Arguments]\n"
+           "\n"
+           "Where:\n"
+           "  effect_1 ... effect_n compressor, overdrive, delay or octaver, each at most once, in chain order\n"
+           "                        Default is compressor\n"
+           "\n"
+           "  e.g. test_load compressor overdrive --nframes 32 --seconds 60\n"
+           "       test_load --graph res/graphs/split_drive.graph\n"
+           "\n"
+           "Additional Arguments (s, u and f denote string, unsigned integer and float values respectively:\n"
+           "\n"
+           "  Interface Parameters - JACK is started on its dummy backend, so no soundcard is needed:\n"
+           "    [--nframes u]       Frames per Period - Must be in the range 1 to 4096\n"
+           "                        Default is 64\n"
+           "    [--fs u]            Sample Rate (Hz) - Must be in the range 44100 to 192000\n"
+           "                        Default is 48000\n"
+           "\n"
+           "  Graph Parameters:\n"
+           "    [--graph s]         Effect Graph Description - Replaces the effect chain (see res/graphs)\n"
+           "\n"
+           "  Load Test Parameters:\n"
+           "    [--file s]          WAV file played into the pedal (looped)\n"
+           "                        Default is a synthetic bass signal\n"
+           "    [--seconds f]       Test Duration (s) - Must be more than 0\n"
+           "                        Default is 10.0f\n"
+           "\n");
+}
+
+static inline int get_args(int argc, char *argv[]){
+    float validf;
+    int validi;
+    char err;
+    int i = 1;
+    while (i < argc){
+        //Find an Effect - Created once the interface is initialised
+        if ((strcmp(argv[i], "compressor") == 0) || (strcmp(argv[i], "overdrive") == 0) || (strcmp(argv[i], "delay") == 0) || (strcmp(argv[i], "octaver") == 0)){
+            for (uint32_t e = 0; e < chain_len; e++){
+                if (strcmp(chain[e], argv[i]) == 0){
+                    printf("[USER-ERROR] %s can only be set once in chain, please refer to usage guide below\n", argv[i]);
+                    print_help();
+                    exit(1);
+                }
+            }
+            chain[chain_len++] = argv[i];
+            i++;
+        }
+        //Find Additional Arguments
+        else if (i == (argc - 1)){
+            printf("[USER-ERROR] Not enough input arguments, please refer to usage guide below\n");
+            print_help();
+            exit(1);
+        }
+        else if (strcmp(argv[i], "--nframes") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 1) || (validi > INTERFACE_MAX_NFRAMES)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            inter->flen = (uint32_t)strlen(argv[i+1]);
+            inter->nframes = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--fs") == 0){
+            if ((sscanf(argv[i+1], "%d %c", &validi, &err) != 1) || (validi < 44100) || (validi > INTERFACE_MAX_FS)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            inter->fslen = (uint32_t)strlen(argv[i+1]);
+            inter->fs = validi;
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--graph") == 0){
+            graph_path = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--file") == 0){
+            file = argv[i+1];
+            i+=2;
+        }
+        else if (strcmp(argv[i], "--seconds") == 0){
+            if ((sscanf(argv[i+1], "%f %c", &validf, &err) != 1) || (validf <= 0.0f)){
+                printf("[USER-ERROR] Invalid value '%s' for '%s', please refer to usage guide below\n", argv[i+1], argv[i]);
+                print_help();
+                exit(1);
+            }
+            seconds = validf;
+            i+=2;
+        }
+        else{
+            printf("[USER-ERROR] Invalid argument '%s', please refer to usage guide below\n", argv[i]);
+            print_help();
+            exit(1);
+        }
+    }
+    //A graph replaces the chain
+    if ((graph_path != NULL) && (chain_len != 0)){
+        printf("[USER-ERROR] Give either an effect chain or --graph, please refer to usage guide below\n");
+        print_help();
+        exit(1);
+    }
+    //Default Chain
+    if ((chain_len == 0) && (graph_path == NULL)){
+        chain[chain_len++] = "compressor";
+    }
+    return 0;
+}
+
+//Create and Initialise one Effect of the chain with its defaults - The graph frees it
+static inline void *chain_effect(const char *name, uint32_t *type){
+    void *effect = NULL;
+    if (strcmp(name, "compressor") == 0){
+        *type = GRAPH_COMPRESSOR;
+        effect = sample_alloc(sizeof(compressor_parameters));
+        if (effect != NULL){
+            compressor_default((compressor_parameters*)effect);
+            compressor_init((compressor_parameters*)effect, inter);
+        }
+    }
+    else if (strcmp(name, "overdrive") == 0){
+        *type = GRAPH_OVERDRIVE;
+        effect = sample_alloc(sizeof(overdrive_parameters));
+        if (effect != NULL){
+            overdrive_default((overdrive_parameters*)effect);
+            if (overdrive_init((overdrive_parameters*)effect, inter)){
+                free(effect);
+                return NULL;
+            }
+        }
+    }
+    else if (strcmp(name, "delay") == 0){
+        *type = GRAPH_DELAY;
+        effect = sample_alloc(sizeof(delay_parameters));
+        if (effect != NULL){
+            delay_default((delay_parameters*)effect);
+            if (delay_init((delay_parameters*)effect, inter)){
+                free(effect);
+                return NULL;
+            }
+        }
+    }
+    else{
+        *type = GRAPH_OCTAVER;
+        effect = sample_alloc(sizeof(octaver_parameters));
+        if (effect != NULL){
+            octaver_default((octaver_parameters*)effect);
+            octaver_init((octaver_parameters*)effect, inter);
+        }
+    }
+    if (effect == NULL){
+        fprintf(stderr, "[ERROR] in %s memory allocation\n", name);
+    }
+    return effect;
+}
+
+//Effect Graph - Loaded from --graph, or a serial chain of the effects named on the command line
+static inline int build_graph(){
+    if (graph_path != NULL){
+        return graph_load(graph, graph_path, inter) || graph_compile(graph, inter);
+    }
+    const char *prev = "in";
+    uint32_t type;
+    for (uint32_t e = 0; e < chain_len; e++){
+        void *effect = chain_effect(chain[e], &type);
+        if (effect == NULL){
+            return 1;
+        }
+        if (graph_add(graph, chain[e], type, prev, effect)){
+            free(effect);
+            return 1;
+        }
+        graph->nodes[graph->nnodes - 1].owned = 1;
+        prev = chain[e];
+    }
+    return graph_compile(graph, inter);
+}
+
+static inline float elapsed(struct timespec *begin, struct timespec *end){
+    return (float)(end->tv_sec - begin->tv_sec) + 1e-9f * (float)(end->tv_nsec - begin->tv_nsec);
+}
+
+static int compare_float(const void *a, const void *b){
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+//Process Callback Function - Pedal client, timed on each block
+int process (jack_nframes_t nframes, void *arg){
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    //Denormals Flushed - As the pedal's process() does
+    sample_flush_denormals();
+    //Initialise pointers in and out to the memory area associated with each
+    jack_default_audio_sample_t *in, *out;
+    in = jack_port_get_buffer (input_port, nframes);
+    out = jack_port_get_buffer (output_port, nframes);
+    //Effect Graph - A fault silences the block and is written out by the logger thread, as in the pedal
+    if (graph_process(in, out, graph, inter)){
+        logger_event(LOGGER_PROCESS, "process", 0);
+        memset(out, 0, nframes * sizeof(jack_default_audio_sample_t));
+    }
+    //Record Timings
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (callbacks < max_callbacks){
+        callback_t[callbacks] = elapsed(&begin, &end);
+        interval_t[callbacks] = (callbacks == 0) ? 0.0f : elapsed(&last_callback, &begin);
+        callbacks++;
+    }
+    last_callback = begin;
+    return 0;
+}
+
+//Playback Callback Function - File-playback client, looping the file
+int playback_process (jack_nframes_t nframes, void *arg){
+    jack_default_audio_sample_t *out = jack_port_get_buffer (player_port, nframes);
+    for (uint32_t i = 0; i < nframes; i++){
+        out[i] = playback.data[playback_pos];
+        playback_pos++;
+        if (playback_pos == playback.length){
+            playback_pos = 0;
+        }
+    }
+    return 0;
+}
+
+//Buffer Size Callback - JACK period differs from, or changed from, the one requested
+int buffer_size (jack_nframes_t nframes, void *arg){
+    if (nframes > INTERFACE_MAX_NFRAMES){
+        fprintf(stderr, "[JACK-ERROR] Period of %u frames is more than the supported %u\n", nframes, INTERFACE_MAX_NFRAMES);
+        exit(1);
+    }
+    if (nframes != inter->nframes){
+        inter->nframes = nframes;
+        graph_update(graph, inter);
+        logger_event(LOGGER_PERIOD, "jack", nframes);
+    }
+    return 0;
+}
+
+//Sample Rate Callback - JACK sample rate differs from, or changed from, the one requested
+int sample_rate (jack_nframes_t fs, void *arg){
+    if (fs > INTERFACE_MAX_FS){
+        fprintf(stderr, "[JACK-ERROR] Sample rate of %uHz is more than the supported %uHz\n", fs, INTERFACE_MAX_FS);
+        exit(1);
+    }
+    if (fs != inter->fs){
+        inter->fs = fs;
+        graph_update(graph, inter);
+        logger_event(LOGGER_RATE, "jack", fs);
+    }
+    return 0;
+}
+
+//XRun Callback - Count missed deadlines
+int xrun (void *arg){
+    xruns++;
+    return 0;
+}
+
+//Shut Down Callback - if client is disconnected
+void jack_shutdown (void *arg){
+    exit (1);
+}
+
+static inline jack_client_t *open_client(const char *client_name){
+    jack_status_t status;
+    jack_client_t *c = jack_client_open (client_name, JackNullOption, &status, NULL);
+    if (c == NULL){
+        fprintf (stderr, "[JACK-ERROR] jack_client_open() failed, status = 0x%2.0x\n", status);
+        if (status & JackServerFailed){
+            fprintf (stderr, "[JACK-ERROR] Unable to connect to JACK server\n");
+        }
+        exit (1);
+    }
+    return c;
+}
+
+//Synthetic Bass Signal - Plucked E1, A1, D2 and G2 with a silent gap between notes
+static inline int synthetic_playback(){
+    const float notes[4] = {41.20f, 55.00f, 73.42f, 98.00f};
+    playback.fs = inter->fs;
+    playback.channels = 1;
+    playback.length = 4 * inter->fs;
+    playback.data = (float*)malloc(playback.length * sizeof(float));
+    if (playback.data == NULL){
+        fprintf(stderr, "[ERROR] in playback memory allocation\n");
+        return 1;
+    }
+    for (uint32_t i = 0; i < playback.length; i++){
+        float f = notes[i / inter->fs];
+        float t = (float)(i % inter->fs) / (float)inter->fs;
+        playback.data[i] = (t > 0.9f) ? 0.0f : 0.6f * expf(-3.0f * t) * (sinf(2.0f * PI * f * t) + 0.4f * sinf(4.0f * PI * f * t));
+    }
+    return 0;
+}
+
+static inline void report(){
+    uint32_t n = callbacks;
+    if (n < 2){
+        printf("[ERROR] Only %u callbacks recorded\n", n);
+        return;
+    }
+    float budget = (float)inter->nframes / (float)inter->fs;
+    float sum = 0.0f, isum = 0.0f, imax = 0.0f, imin = 1.0f;
+    for (uint32_t i = 0; i < n; i++){
+        sum += callback_t[i];
+    }
+    for (uint32_t i = 1; i < n; i++){
+        isum += interval_t[i];
+        imax = (interval_t[i] > imax) ? interval_t[i] : imax;
+        imin = (interval_t[i] < imin) ? interval_t[i] : imin;
+    }
+    qsort(callback_t, n, sizeof(float), compare_float);
+    printf("\n"
+           "/-----LOAD TEST RESULTS-----/\n"
+           "\n"
+           "Callbacks:            %u (budget %.1fus per %u-frame period at %uHz)\n"
+           "XRuns:                %u\n"
+           "Callback time (us):   mean %.2f, p50 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n"
+           "Worst-case headroom:  %.1f%% of period\n"
+           "Period interval (us): mean %.2f, min %.2f, max %.2f\n",
+           n, 1e6f * budget, inter->nframes, inter->fs, xruns,
+           1e6f * sum / (float)n, 1e6f * callback_t[n / 2], 1e6f * callback_t[(n * 99) / 100],
+           1e6f * callback_t[(n * 999) / 1000], 1e6f * callback_t[n - 1],
+           100.0f * (1.0f - callback_t[n - 1] / budget),
+           1e6f * isum / (float)(n - 1), 1e6f * imin, 1e6f * imax);
+}
+
+int main (int argc, char *argv[]){
+    //Parameter Memory Allocation
+    inter = malloc(sizeof(interface_parameters));
+    if (inter == NULL){
+        fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
+        exit(1);
+    }
+    graph = malloc(sizeof(graph_parameters));
+    if (graph == NULL){
+        fprintf(stderr, "[ERROR] in graph_parameters memory allocation\n");
+        exit(1);
+    }
+    //Parameter Defaults
+    if(interface_default(inter)){
+        fprintf(stderr,"[ERROR] in initialising interface defaults\n");
+        exit(1);
+    }
+    graph_default(graph);
+    //Get Parameter Arguments
+    if(get_args(argc, argv)){
+        fprintf(stderr,"[ERROR] in getting parameter arguments\n");
+        exit(1);
+    }
+    //Playback Signal
+    if (file != NULL){
+        if (wav_read(file, &playback)){
+            exit(1);
+        }
+        if (playback.fs != inter->fs){
+            printf("[USER-WARNING] '%s' is %uHz but JACK runs at %uHz - played without resampling\n", file, playback.fs, inter->fs);
+        }
+    }
+    else if (synthetic_playback()){
+        exit(1);
+    }
+    //Timing Memory Allocation
+    max_callbacks = (uint32_t)(seconds * (float)inter->fs / (float)inter->nframes) + 1;
+    callback_t = malloc(max_callbacks * sizeof(float));
+    interval_t = malloc(max_callbacks * sizeof(float));
+    if ((callback_t == NULL) || (interval_t == NULL)){
+        fprintf(stderr, "[ERROR] in timing memory allocation\n");
+        exit(1);
+    }
+
+    //Parameter Initialisation
+    printf("\n"
+    "/-----INTERFACE CONFIGURATION-----/\n"
+    "\n");
+    inter->dummy = 1;
+    interface_init(inter);
+    if(build_graph()){
+        fprintf(stderr,"[ERROR] in effect graph initialisation\n");
+        exit(1);
+    }
+    graph_print(graph);
+
+    //Logger Thread - Writes out what the callbacks record, off the real-time path
+    if (logger_start()){
+        fprintf(stderr, "[ERROR] in logger initialisation\n");
+        exit(1);
+    }
+    //JACK Initialisation - Pedal and file-playback clients
+    client = open_client("raspberry_ripple");
+    player = open_client("rripple_player");
+    jack_set_process_callback (client, process, 0);
+    jack_set_process_callback (player, playback_process, 0);
+    jack_set_buffer_size_callback (client, buffer_size, 0);
+    jack_set_sample_rate_callback (client, sample_rate, 0);
+    jack_set_xrun_callback (client, xrun, 0);
+    jack_on_shutdown (client, jack_shutdown, 0);
+    jack_on_shutdown (player, jack_shutdown, 0);
+    input_port = jack_port_register (client, "input",
+                     JACK_DEFAULT_AUDIO_TYPE,
+                     JackPortIsInput, 0);
+    output_port = jack_port_register (client, "output",
+                      JACK_DEFAULT_AUDIO_TYPE,
+                      JackPortIsOutput, 0);
+    player_port = jack_port_register (player, "output",
+                      JACK_DEFAULT_AUDIO_TYPE,
+                      JackPortIsOutput, 0);
+    if ((input_port == NULL) || (output_port == NULL) || (player_port == NULL)){
+        fprintf(stderr, "[JACK-ERROR] Cannot register JACK ports\n");
+        exit (1);
+    }
+    if (jack_get_buffer_size(client) != inter->nframes){
+        printf("[USER-WARNING] JACK is running at %u frames, not %u\n", jack_get_buffer_size(client), inter->nframes);
+    }
+    //Run Load Test
+    printf("\n"
+    "/-----RASPBERRY RIPPLE LOAD TEST-----/\n");
+    print_about();
+    if (jack_activate (player) || jack_activate (client)){
+        fprintf (stderr, "[JACK-ERROR] Cannot activate client");
+        exit (1);
+    }
+    //Connect Player -> Pedal -> Dummy Playback
+    if (jack_connect (player, jack_port_name (player_port), jack_port_name (input_port))){
+        fprintf (stderr, "[JACK-ERROR] Cannot connect playback client to pedal input\n");
+        exit (1);
+    }
+    const char **ports = jack_get_ports (client, NULL, NULL, JackPortIsPhysical|JackPortIsInput);
+    if (ports != NULL){
+        if (jack_connect (client, jack_port_name (output_port), ports[0])){
+            fprintf (stderr, "[JACK-WARNING] Cannot connect output port\n");
+        }
+        jack_free (ports);
+    }
+    //Sample CPU Load until the duration has elapsed
+    float load, load_sum = 0.0f, load_max = 0.0f;
+    uint32_t samples = 0;
+    uint32_t total = (uint32_t)(seconds * 1e6f / CPU_LOAD_INTERVAL);
+    printf("Running for %.1fs...\n", seconds);
+    for (samples = 0; samples < total; samples++){
+        usleep(CPU_LOAD_INTERVAL);
+        load = jack_cpu_load(client);
+        load_sum += load;
+        load_max = (load > load_max) ? load : load_max;
+    }
+    jack_deactivate (client);
+    jack_deactivate (player);
+    //Report
+    report();
+    printf("JACK CPU load (%%):     mean %.2f, max %.2f\n", load_sum / (float)((samples > 0) ? samples : 1), load_max);
+    jack_client_close (client);
+    jack_client_close (player);
+    system("killall jackd");
+    wav_free(&playback);
+    graph_free(graph);
+    //Clients are closed by now, so no callback is still recording
+    logger_stop();
+    logger_summary(stderr);
+    exit (((xruns == 0) && (logger_count(LOGGER_PROCESS) == 0)) ? 0 : 2);
+}
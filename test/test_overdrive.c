@@ -15,8 +15,6 @@
 #include "interface.h"
 #include "test.h"
 
-#define THRESHOLD 0.3333333f
-
 jack_port_t *input_port;
 jack_port_t *output_port_1;
 jack_port_t *output_port_2;
@@ -29,6 +27,7 @@ jack_client_t *client;
 interface_parameters *inter;
 overdrive_parameters *drive;
 compressor_parameters *comp;
+overdrive_sweep_parameters *sweep;
 test_timer timer = {
     {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f},
     {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}
@@ -205,32 +204,6 @@ static inline int get_args(int argc, char *argv[]){
     return 0;
 }
 
-static inline void effects_chain(jack_default_audio_sample_t *in, jack_default_audio_sample_t *out, compressor_parameters *comp, overdrive_parameters *drive, interface_parameters *inter){
-    if (comp->chain == 1){
-        if (compressor(in, out, comp, inter)){
-            fprintf(stderr,"[ERROR] in compressor effect\n");
-            exit(1);
-        }
-        if (drive->chain == 2){
-            overdrive(out, out, drive, inter);
-        }
-    }
-    else if (drive->chain == 1){
-        overdrive(in, out, drive, inter);
-        if (comp->chain == 2){
-            if (compressor(out, out, comp, inter)){
-                fprintf(stderr,"[ERROR] in compressor effect\n");
-                exit(1);
-            }
-        }
-    }
-    else{
-        memcpy(out, in, (sizeof(jack_default_audio_sample_t) * inter->nframes));
-        fprintf(stderr, "[ERROR] in main process\n");
-        exit(1);
-    }
-}
-
 static inline void timer_calcs(float *t, clock_t begin, clock_t end){
     t[0] = (float)(end - begin) / CLOCKS_PER_SEC;
     if(t[0]>t[1]){
@@ -254,146 +227,18 @@ int process (jack_nframes_t nframes, void *arg){
     out_5 = jack_port_get_buffer (output_port_5, nframes);
     out_6 = jack_port_get_buffer (output_port_6, nframes);
     
-    //Control Params
-    float peak = drive->peak;
-    float peak_count = drive->peak_count;
+    jack_default_audio_sample_t *out[6] = {out_1, out_2, out_3, out_4, out_5, out_6};
     
-    //Global Params
-    comp->chain = 0;
-    drive->chain = 1;
-    
-    //out_1 Timer Start
+    //Sweep Timer Start
     begin = clock();
-    //Params - Overdrive = 0.0
-    drive->drive = 0.0f;
-    drive->peak = peak;
-    drive->peak_count = peak_count;
-    //Adjust Dependants
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
-    drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < 2 * THRESHOLD){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
-    }
+    //Params - Overdrive = 0.0, 0.2, 0.4, 0.6, 0.8 and 1.0, one variant per sweep lane
     //Effect
-    effects_chain(in, out_1, comp, drive, inter);
-    //out_1 Timer End
+    overdrive_sweep(in, out, drive, sweep, inter);
+    //Sweep Timer End
     end = clock();
-    //out_1 Timer Calculations
+    //Sweep Timer Calculations
     timer_calcs(timer.t1, begin, end);
     
-    //out_2 Timer Start
-    begin = clock();
-    //Params - Overdrive = 0.2
-    drive->drive = 0.2f;
-    drive->peak = peak;
-    drive->peak_count = peak_count;
-    //Adjust Coefficients
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
-    drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < 2 * THRESHOLD){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
-    }
-    //Effect
-    effects_chain(in, out_2, comp, drive, inter);
-    //out_2 Timer End
-    end = clock();
-    //out_2 Timer Calculations
-    timer_calcs(timer.t2, begin, end);
-    
-    //out_3 Timer Start
-    begin = clock();
-    //Params - Overdrive = 0.4
-    drive->drive = 0.4f;
-    drive->peak = peak;
-    drive->peak_count = peak_count;
-    //Adjust Coefficients
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
-    drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < 2 * THRESHOLD){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
-    }
-    //Effect
-    effects_chain(in, out_3, comp, drive, inter);
-    //out_3 Timer End
-    end = clock();
-    //out_3 Timer Calculations
-    timer_calcs(timer.t3, begin, end);
-    
-    //out_4 Timer Start
-    begin = clock();
-   //Params - Overdrive = 0.6
-    drive->drive = 0.6f;
-    drive->peak = peak;
-    drive->peak_count = peak_count;
-    //Adjust Coefficients
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
-    drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < 2 * THRESHOLD){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
-    }
-    //Effect
-    effects_chain(in, out_4, comp, drive, inter);
-    //out_4 Timer End
-    end = clock();
-    //out_4 Timer Calculations
-    timer_calcs(timer.t4, begin, end);
-    
-    //out_5 Timer Start
-    begin = clock();
-    //Params - Overdrive = 0.8
-    drive->drive = 0.8f;
-    drive->peak = peak;
-    drive->peak_count = peak_count;
-    //Adjust Coefficients
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
-    drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < 2 * THRESHOLD){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
-    }
-    //Effect
-    effects_chain(in, out_5, comp, drive, inter);
-    //out_5 Timer End
-    end = clock();
-    //out_5 Timer Calculations
-    timer_calcs(timer.t5, begin, end);
-    
-    //out_6 Timer Start
-    begin = clock();
-    //Params - Overdrive = 1.0
-    drive->drive = 1.0f;
-    drive->peak = peak;
-    drive->peak_count = peak_count;
-    //Adjust Coefficients
-    drive->drive_coeff = 1.0f + (2.0f * powf((1.0f - drive->drive), 2.5f));
-    drive->inv_drive_coeff = 1.0f / drive->drive_coeff;
-    if (drive->inv_drive_coeff < 2 * THRESHOLD){
-        drive->norm_factor = drive->drive_coeff * (3.0f - powf((2.0f - drive->inv_drive_coeff * 3.0f), 2.0f)) / 3.0f;
-    }
-    else{
-        drive->norm_factor = drive->drive_coeff;
-    }
-    //Effect
-    effects_chain(in, out_6, comp, drive, inter);
-    //out_6 Timer End
-    end = clock();
-    //out_6 Timer Calculations
-    timer_calcs(timer.t6, begin, end);
-    
     //Overall Timer End
     overall_end = clock();
     //Overall Timer Calculations
@@ -424,12 +269,12 @@ int main (int argc, char *argv[]){
         fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
         exit(1);
     }
-    comp = malloc(sizeof(compressor_parameters));
+    comp = sample_alloc(sizeof(compressor_parameters));
     if (comp == NULL){
         fprintf(stderr, "[ERROR] in compressor_parameters memory allocation\n");
         exit(1);
     }
-    drive = malloc(sizeof(overdrive_parameters));
+    drive = sample_alloc(sizeof(overdrive_parameters));
     if (drive == NULL){
         fprintf(stderr, "[ERROR] in overdrive_parameters memory allocation\n");
         exit(1);
@@ -457,6 +302,19 @@ int main (int argc, char *argv[]){
         fprintf(stderr,"[ERROR] in overdrive parameter initialisation\n");
         exit(1);
     }
+    //Sweep Initialisation - Overdrive = 0.0, 0.2, 0.4, 0.6, 0.8 and 1.0
+    sweep = malloc(sizeof(overdrive_sweep_parameters));
+    if (sweep == NULL){
+        fprintf(stderr, "[ERROR] in overdrive_sweep_parameters memory allocation\n");
+        exit(1);
+    }
+    const float drive_level[6] = {0.0f, 0.2f, 0.4f, 0.6f, 0.8f, 1.0f};
+    overdrive_sweep_default(sweep, drive);
+    sweep->lanes = 6;
+    for (uint32_t k = 0; k < sweep->lanes; k++){
+        sweep->drive[k] = drive_level[k];
+    }
+    overdrive_sweep_init(sweep, inter);
     
     
     /*...JACK Initialisation...*/
@@ -31,6 +31,8 @@ jack_client_t *client;
 interface_parameters *inter;
 overdrive_parameters *drive;
 compressor_parameters *comp;
+void *comp_state;
+void *drive_state;
 test_timer timer = {
     {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f},
     {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 0.0f}
@@ -382,10 +384,9 @@ int process (jack_nframes_t nframes, void *arg){
     out_7 = jack_port_get_buffer (output_port_7, nframes);
     out_8 = jack_port_get_buffer (output_port_8, nframes);
     
-    //Control Params
-    float gs[2] = {comp->gs[0], comp->gs[1]};
-    float peak = drive->peak;
-    float peak_count = drive->peak_count;
+    //Control Params - Every variant starts from the same effect state
+    compressor_snapshot(comp, comp_state);
+    overdrive_snapshot(drive, drive_state);
     
     //Global Params
     comp->compression_db = 6.0f;
@@ -406,10 +407,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - Just compressor at default params
     comp->chain = 1;
     drive->chain = 0;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_1, comp, drive, inter);
     //out_1 Timer End
@@ -422,10 +421,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - Just overdrive at default params
     comp->chain = 0;
     drive->chain = 1;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_2, comp, drive, inter);
     //out_2 Timer End
@@ -438,10 +435,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - compressor->overdrive at default params
     comp->chain = 1;
     drive->chain = 2;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_3, comp, drive, inter);
     //out_3 Timer End
@@ -454,10 +449,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - overdrive->compressor at default params
     comp->chain = 2;
     drive->chain = 1;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_4, comp, drive, inter);
     //out_4 Timer End
@@ -484,10 +477,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - Just compressor at double compression
     comp->chain = 1;
     drive->chain = 0;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_5, comp, drive, inter);
     //out_5 Timer End
@@ -500,10 +491,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - Just overdrive at double drive
     comp->chain = 0;
     drive->chain = 1;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_6, comp, drive, inter);
     //out_6 Timer End
@@ -516,10 +505,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - compressor->overdrive at double compression and drive
     comp->chain = 1;
     drive->chain = 2;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_7, comp, drive, inter);
     //out_7 Timer End
@@ -532,10 +519,8 @@ int process (jack_nframes_t nframes, void *arg){
     //Params - overdrive->compressor at double compression and drive
     comp->chain = 2;
     drive->chain = 1;
-    comp->gs[0] = gs[0];
-    comp->gs[1] = gs[1];
-    drive->peak = peak;
-    drive->peak_count = peak_count;
+    compressor_restore(comp, comp_state);
+    overdrive_restore(drive, drive_state);
     //Effect
     effects_chain(in, out_8, comp, drive, inter);
     //out_8 Timer End
@@ -573,12 +558,12 @@ int main (int argc, char *argv[]){
         fprintf(stderr, "[ERROR] in interface_parameters memory allocation\n");
         exit(1);
     }
-    comp = malloc(sizeof(compressor_parameters));
+    comp = sample_alloc(sizeof(compressor_parameters));
     if (comp == NULL){
         fprintf(stderr, "[ERROR] in compressor_parameters memory allocation\n");
         exit(1);
     }
-    drive = malloc(sizeof(overdrive_parameters));
+    drive = sample_alloc(sizeof(overdrive_parameters));
     if (drive == NULL){
         fprintf(stderr, "[ERROR] in overdrive_parameters memory allocation\n");
         exit(1);
@@ -606,6 +591,13 @@ int main (int argc, char *argv[]){
         fprintf(stderr,"[ERROR] in overdrive parameter initialisation\n");
         exit(1);
     }
+    //State Snapshot Memory Allocation
+    comp_state = malloc(compressor_state_size(comp));
+    drive_state = malloc(overdrive_state_size(drive));
+    if ((comp_state == NULL) || (drive_state == NULL)){
+        fprintf(stderr, "[ERROR] in state snapshot memory allocation\n");
+        exit(1);
+    }
     
     
     /*...JACK Initialisation...*/
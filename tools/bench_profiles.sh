@@ -0,0 +1,59 @@
+#!/bin/sh
+# Builds each profile in turn (default, PROFILE=fast and make pgo), runs the effect and graph benchmarks and
+# renders the test recordings, then prints each benchmark's time against the default build
+# Each is run REPEATS times (default 3) and the best kept, as one slow run is usually another process
+# Extra arguments are passed to bench, e.g. ./tools/bench_profiles.sh --nframes 128
+OUT=$(mktemp -d)
+REPEATS=${REPEATS:-3}
+# Rendered recordings are not among those make pgo trains on (res/test_recordings/*/*/*0.wav)
+RENDER="res/test_recordings/1/11/115.wav res/test_recordings/2/23/235.wav res/test_recordings/3/35/355.wav"
+for profile in default fast pgo
+do
+  make clean > /dev/null
+  case $profile in
+    default) make > $OUT/build.log 2>&1 ;;
+    fast) make PROFILE=fast > $OUT/build.log 2>&1 ;;
+    pgo) make pgo > $OUT/build.log 2>&1 ;;
+  esac
+  if [ $? -ne 0 ]; then
+    cat $OUT/build.log
+    echo "[ERROR] in building the $profile profile"
+    exit 1
+  fi
+  : > $OUT/$profile.txt
+  for r in $(seq $REPEATS)
+  do
+    ./usr/bin/bench effects "$@" >> $OUT/$profile.txt || exit 1
+    ./usr/bin/bench graph "$@" >> $OUT/$profile.txt || exit 1
+    echo "Offline Render (rripple_render, default chain)" >> $OUT/$profile.txt
+    for f in $RENDER
+    do
+      ./usr/bin/rripple_render $f /dev/null | sed "s|.* in \([0-9.]*\)s (\([0-9.]*\)x.*|  $f \2 x-real-time|" >> $OUT/$profile.txt
+    done
+  done
+done
+make clean > /dev/null
+# Rows are "<name> <value> ns/block" or "<name> <value> x-real-time" under a section heading
+# - Keeps the lowest time and highest real-time factor of the repeats, speedups are against the default build
+awk '
+  /^[A-Z]/{ section = $0 }
+  /ns\/block|x-real-time/{
+    for (i = 1; i <= NF; i++) if ($i == "ns/block" || $i == "x-real-time") break
+    name = $1; for (j = 2; j < i - 1; j++) name = name " " $j
+    key = section SUBSEP name
+    if (!(key in unit)){ unit[key] = $i; order[n++] = key }
+    v = $(i - 1)
+    if (!((key, FILENAME) in value) || (unit[key] == "ns/block" && v < value[key, FILENAME]) ||
+        (unit[key] == "x-real-time" && v > value[key, FILENAME])) value[key, FILENAME] = v
+  }
+  END{
+    printf "%-40s %12s %12s %8s %12s %8s\n", "", "default", "fast", "", "pgo", ""
+    for (k = 0; k < n; k++){
+      key = order[k]; split(key, part, SUBSEP)
+      if (part[1] != last){ printf "%s\n", part[1]; last = part[1] }
+      d = value[key, ARGV[1]]; f = value[key, ARGV[2]]; p = value[key, ARGV[3]]
+      if (unit[key] == "ns/block") printf "  %-38s %12.1f %12.1f %7.2fx %12.1f %7.2fx\n", part[2], d, f, d / f, p, d / p
+      else printf "  %-38s %11.1fx %11.1fx %7.2fx %11.1fx %7.2fx\n", part[2], d, f, f / d, p, p / d
+    }
+  }' $OUT/default.txt $OUT/fast.txt $OUT/pgo.txt
+rm -rf $OUT